@@ -0,0 +1,314 @@
+/**
+ * @file bench.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Medición del tiempo de cada fase del análisis de una imagen.
+ *
+ * Para cada imagen repite el mismo recorrido que hace listpart y mide con
+ * CLOCK_MONOTONIC cada fase por separado:
+ *
+ * - open: disk_open (incluye la proyección en memoria de las imágenes).
+ * - read_lba0: lectura del primer sector y detección del esquema.
+ * - read_header: lectura y validación de la cabecera GPT (0 en MBR).
+ * - read_entries: GPT: gpt_load_tables; MBR: recorrido de la cadena EBR.
+ * - decode: tipo y nombre de cada partición.
+ * - print: tablas de texto hacia /dev/null.
+ * - close: disk_close.
+ *
+ * Luego analiza todas las imágenes en lote con liblistpart, con 1 y con N
+ * hilos, y reporta discos por segundo.
+ *
+ * La salida es una tabla separada por espacios con una cabecera de versión;
+ * las filas salen siempre en el mismo orden para poder compararlas con diff
+ * entre versiones (solo cambian los números).
+ *
+ * Uso: bench [-n ITERACIONES] [-j HILOS] <imagen>...
+ * @copyright MIT License
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "listpart.h"
+#include "pool.h"
+#include "print.h"
+
+/**
+ * @def BENCH_FORMAT_VERSION
+ * @brief Versión del formato de salida; cambia solo si cambian las columnas.
+ */
+#define BENCH_FORMAT_VERSION 1
+
+/**
+ * @def BENCH_BATCH_ROUNDS
+ * @brief Veces que se analiza la lista completa de imágenes en cada lote.
+ */
+#define BENCH_BATCH_ROUNDS 20
+
+/**
+ * @enum bench_phase
+ * @brief Fases medidas de un análisis.
+ */
+typedef enum {
+	PHASE_OPEN,
+	PHASE_READ_LBA0,
+	PHASE_READ_HEADER,
+	PHASE_READ_ENTRIES,
+	PHASE_DECODE,
+	PHASE_PRINT,
+	PHASE_CLOSE,
+	PHASE_COUNT
+} bench_phase;
+
+static const char *bench_phase_names[PHASE_COUNT] = {
+	"open", "read_lba0", "read_header", "read_entries", "decode", "print", "close"
+};
+
+/**
+ * @struct bench_batch
+ * @brief Contexto de un análisis en lote.
+ */
+typedef struct {
+	char **paths;   ///< Imágenes a analizar.
+	int count;      ///< Cantidad de imágenes.
+} bench_batch;
+
+static unsigned long long now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Decodifica el tipo y el nombre de los descriptores ocupados.
+ *
+ * @return Cantidad de particiones decodificadas.
+ */
+static unsigned int decode_gpt(const gpt_table *table) {
+	const gpt_header *hdr = &table->header;
+	unsigned int count = 0;
+
+	for (unsigned int j = 0; j < hdr->num_partition_entries; j++) {
+		gpt_partition_descriptor *desc =
+			(gpt_partition_descriptor *)(table->entries + (size_t)j * hdr->size_partition_entry);
+		char name[GPT_NAME_LEN];
+		if (is_null_descriptor(desc)) {
+			continue;
+		}
+		const gpt_partition_type *type = gpt_partition_type_by_guid(&desc->partition_type_guid);
+		gpt_decode_partition_name(desc->partition_name, name);
+		count += type != NULL && name[0] != '\0';
+	}
+	return count;
+}
+
+static void print_gpt(FILE *out, disk_handle *disk, mbr *boot_record, gpt_table *table) {
+	const gpt_header *hdr = &table->header;
+
+	print_gpt_protective_mbr_table(out, boot_record, disk->sector_size);
+	print_gpt_header(out, &table->header, disk->sector_size);
+	for (unsigned int j = 0; j < hdr->num_partition_entries; j++) {
+		gpt_partition_descriptor *desc =
+			(gpt_partition_descriptor *)(table->entries + (size_t)j * hdr->size_partition_entry);
+		if (!is_null_descriptor(desc)) {
+			print_gpt_partition_table(out, desc, disk->sector_size);
+		}
+	}
+}
+
+/**
+ * @brief Analiza una imagen una vez y acumula el tiempo de cada fase.
+ *
+ * @return int 1 si se pudo abrir y leer la imagen, 0 en caso de error.
+ */
+static int bench_once(const char *path, FILE *null_out, unsigned long long elapsed[PHASE_COUNT]) {
+	static mbr_logical_partition logical[4][MBR_MAX_LOGICAL_PARTITIONS];
+	int logical_count[4] = {0, 0, 0, 0};
+	char sector[DISK_MAX_SECTOR_SIZE];
+	disk_handle disk;
+	gpt_table primary, backup;
+	mbr boot_record;
+	int scheme;
+	unsigned long long t0, t1;
+
+	t0 = now_ns();
+	if (!disk_open(&disk, path)) {
+		return 0;
+	}
+	t1 = now_ns();
+	elapsed[PHASE_OPEN] += t1 - t0;
+
+	t0 = t1;
+	if (!read_lba_sector(&disk, 0, sector)) {
+		disk_close(&disk);
+		return 0;
+	}
+	memcpy(&boot_record, sector, sizeof(mbr));
+	scheme = is_mbr(&boot_record);
+	t1 = now_ns();
+	elapsed[PHASE_READ_LBA0] += t1 - t0;
+
+	if (scheme == 2) {
+		gpt_table *table;
+
+		t0 = t1;
+		if (read_lba_sector(&disk, 1, sector)) {
+			is_valid_gpt_header((gpt_header *)sector);
+		}
+		t1 = now_ns();
+		elapsed[PHASE_READ_HEADER] += t1 - t0;
+
+		// gpt_load_tables vuelve a validar la cabecera, que ya está en caché
+		t0 = t1;
+		gpt_load_tables(&disk, 0, &primary, &backup);
+		table = primary.header_valid ? &primary : &backup;
+		t1 = now_ns();
+		elapsed[PHASE_READ_ENTRIES] += t1 - t0;
+
+		if (table->entries != NULL) {
+			t0 = t1;
+			decode_gpt(table);
+			t1 = now_ns();
+			elapsed[PHASE_DECODE] += t1 - t0;
+
+			t0 = t1;
+			print_gpt(null_out, &disk, &boot_record, table);
+			fflush(null_out);
+			t1 = now_ns();
+			elapsed[PHASE_PRINT] += t1 - t0;
+		}
+		gpt_free_table(&primary);
+		gpt_free_table(&backup);
+	} else if (scheme == 1) {
+		t0 = t1;
+		for (int i = 0; i < 4; i++) {
+			const mbr_partition_descriptor *desc = &boot_record.partition_table[i];
+			if (is_extended_partition(desc->partition_type)) {
+				logical_count[i] = mbr_read_logical_partitions(&disk, desc, logical[i], MBR_MAX_LOGICAL_PARTITIONS);
+			}
+		}
+		t1 = now_ns();
+		elapsed[PHASE_READ_ENTRIES] += t1 - t0;
+
+		t0 = t1;
+		for (int i = 0; i < 4; i++) {
+			mbr_partition_type_name(boot_record.partition_table[i].partition_type);
+			for (int j = 0; j < logical_count[i]; j++) {
+				mbr_partition_type_name(logical[i][j].entry.partition_type);
+			}
+		}
+		t1 = now_ns();
+		elapsed[PHASE_DECODE] += t1 - t0;
+
+		t0 = t1;
+		print_mbr_partition_table(null_out, &boot_record, disk.sector_size, NULL);
+		for (int i = 0; i < 4; i++) {
+			if (logical_count[i] > 0) {
+				print_mbr_logical_partitions(null_out, logical[i], logical_count[i], disk.sector_size, NULL);
+			}
+		}
+		fflush(null_out);
+		t1 = now_ns();
+		elapsed[PHASE_PRINT] += t1 - t0;
+	}
+
+	t0 = now_ns();
+	disk_close(&disk);
+	elapsed[PHASE_CLOSE] += now_ns() - t0;
+	return 1;
+}
+
+/**
+ * @brief Trabajo del lote: analiza una imagen con liblistpart.
+ */
+static int batch_job(int index, FILE *out, void *ctx) {
+	bench_batch *batch = (bench_batch *)ctx;
+	listpart_partition parts[128];
+	listpart_result result;
+
+	(void)out;
+	listpart_result_init(&result, parts, 128);
+	return !listpart_parse_device(batch->paths[index % batch->count], 0, &result);
+}
+
+/**
+ * @brief Nombre de la imagen sin el directorio.
+ */
+static const char *base_name(const char *path) {
+	const char *slash = strrchr(path, '/');
+	return slash != NULL ? slash + 1 : path;
+}
+
+int main(int argc, char *argv[]) {
+	int iterations = 100;
+	int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	int opt;
+	int failed = 0;
+	FILE *null_out;
+
+	while ((opt = getopt(argc, argv, "n:j:")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			break;
+		default:
+			fprintf(stderr, "Uso: %s [-n ITERACIONES] [-j HILOS] <imagen>...\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind >= argc || iterations < 1) {
+		fprintf(stderr, "Uso: %s [-n ITERACIONES] [-j HILOS] <imagen>...\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (jobs < 1) {
+		jobs = 1;
+	}
+	null_out = fopen("/dev/null", "w");
+	if (null_out == NULL) {
+		perror("/dev/null");
+		return EXIT_FAILURE;
+	}
+
+	printf("# listpart-bench %d\n", BENCH_FORMAT_VERSION);
+	printf("# imagen fase iteraciones ns_por_iteracion\n");
+	for (int i = optind; i < argc; i++) {
+		unsigned long long elapsed[PHASE_COUNT] = {0};
+		int ok = 1;
+
+		// Una pasada previa para que todas las iteraciones partan de la caché caliente
+		ok = bench_once(argv[i], null_out, elapsed);
+		memset(elapsed, 0, sizeof(elapsed));
+		for (int n = 0; ok && n < iterations; n++) {
+			ok = bench_once(argv[i], null_out, elapsed);
+		}
+		if (!ok) {
+			fprintf(stderr, "Error: No se pudo analizar la imagen %s\n", argv[i]);
+			failed++;
+			continue;
+		}
+		for (int p = 0; p < PHASE_COUNT; p++) {
+			printf("%s %s %d %llu\n", base_name(argv[i]), bench_phase_names[p], iterations,
+					elapsed[p] / (unsigned long long)iterations);
+		}
+	}
+
+	bench_batch batch = { argv + optind, argc - optind };
+	int total = batch.count * BENCH_BATCH_ROUNDS;
+	printf("# lote hilos discos discos_por_segundo\n");
+	for (int j = 1; ; j = jobs) {
+		unsigned long long t0 = now_ns();
+		pool_run(total, j, batch_job, &batch, null_out);
+		unsigned long long ns = now_ns() - t0;
+		printf("batch %d %d %.0f\n", j, total, ns > 0 ? total * 1e9 / (double)ns : 0.0);
+		if (j == jobs) {
+			break;
+		}
+	}
+
+	fclose(null_out);
+	return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
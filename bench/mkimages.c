@@ -0,0 +1,290 @@
+/**
+ * @file mkimages.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Generador de imágenes sintéticas para las pruebas de rendimiento.
+ *
+ * Escribe en un directorio un conjunto fijo de imágenes que cubre los casos
+ * que recorre listpart: MBR con y sin cadena EBR, GPT de distintos tamaños,
+ * sectores de 4096 bytes y tablas corruptas. Las imágenes son archivos
+ * dispersos (solo se escriben las estructuras) y su contenido es siempre el
+ * mismo, de modo que los resultados son comparables entre versiones.
+ *
+ * Uso: mkimages <directorio>
+ * @copyright MIT License
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "crc32.h"
+#include "gpt.h"
+#include "mbr.h"
+
+/**
+ * @enum gpt_corruption
+ * @brief Daño que se aplica a la tabla GPT primaria.
+ */
+typedef enum {
+	CORRUPT_NONE = 0,    ///< Tabla íntegra.
+	CORRUPT_HEADER = 1,  ///< CRC32 de la cabecera primaria incorrecto.
+	CORRUPT_ENTRIES = 2  ///< Arreglo de descriptores primario que no coincide con su CRC32.
+} gpt_corruption;
+
+/** @brief GUIDs de tipo que se asignan de forma rotativa a las particiones GPT. */
+static const char *bench_gpt_types[] = {
+	"C12A7328-F81F-11D2-BA4B-00A0C93EC93B",
+	"0FC63DAF-8483-4772-8E79-3D69D8477DE4",
+	"EBD0A0A2-B9E5-4433-87C0-68B6B72699C7",
+	"0657FD6D-A4AB-43C4-84E5-0933C84B4F4F",
+};
+
+/** @brief Estado del generador pseudoaleatorio de los GUID únicos. */
+static unsigned long long bench_seed = 0x6c69737470617274ULL;
+
+/**
+ * @brief Llena `buf` con bytes pseudoaleatorios reproducibles.
+ */
+static void fill_random(void *buf, size_t len) {
+	unsigned char *p = (unsigned char *)buf;
+	for (size_t i = 0; i < len; i++) {
+		bench_seed = bench_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		p[i] = (unsigned char)(bench_seed >> 56);
+	}
+}
+
+/**
+ * @brief Escribe `len` bytes en la posición `offset` del archivo.
+ *
+ * @return int 1 si se escribió todo, 0 en caso de error.
+ */
+static int put(int fd, unsigned long long offset, const void *buf, size_t len) {
+	const char *p = (const char *)buf;
+	while (len > 0) {
+		ssize_t n = pwrite(fd, p, len, (off_t)offset);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return 0;
+		}
+		p += n;
+		offset += (unsigned long long)n;
+		len -= (size_t)n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Crea (o trunca) una imagen dispersa de `size` bytes.
+ *
+ * @return Descriptor abierto, o -1 en caso de error.
+ */
+static int create_image(const char *dir, const char *name, unsigned long long size) {
+	char path[4096];
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		perror(path);
+		return -1;
+	}
+	if (ftruncate(fd, (off_t)size) < 0) {
+		perror(path);
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static int finish_image(int fd, const char *name, int ok) {
+	if (close(fd) < 0) {
+		ok = 0;
+	}
+	if (!ok) {
+		fprintf(stderr, "Error: No se pudo escribir la imagen %s\n", name);
+	}
+	return ok;
+}
+
+static void set_partition(mbr_partition_descriptor *desc, unsigned char type, unsigned int start,
+		unsigned int size) {
+	memset(desc, 0, sizeof(mbr_partition_descriptor));
+	desc->partition_type = type;
+	desc->start_lba = start;
+	desc->size = size;
+}
+
+/**
+ * @brief Genera una imagen MBR con una partición primaria y, opcionalmente,
+ *        una partición extendida con `logical` particiones lógicas.
+ *
+ * Cada partición lógica ocupa un bloque de 2048 sectores que empieza con su
+ * EBR. Con `loop`, el último EBR enlaza de nuevo con el segundo: el enlace
+ * al primero tendría desplazamiento 0, que indica el fin de la cadena.
+ */
+static int write_mbr_image(const char *dir, const char *name, int logical, int loop) {
+	const unsigned int block = 2048;
+	unsigned int ext_start = 2 * block;
+	unsigned int ext_size = (unsigned int)logical * block;
+	unsigned long long sectors = ext_start + ext_size + block;
+	mbr record;
+	int ok = 1;
+	int fd = create_image(dir, name, sectors * SECTOR_SIZE);
+
+	if (fd < 0) {
+		return 0;
+	}
+
+	memset(&record, 0, sizeof(mbr));
+	set_partition(&record.partition_table[0], 0x83, block, block);
+	record.partition_table[0].boot_flag = 0x80;
+	if (logical > 0) {
+		set_partition(&record.partition_table[1], 0x0F, ext_start, ext_size);
+	}
+	record.signature = 0xAA55;
+	ok = put(fd, 0, &record, sizeof(mbr));
+
+	for (int i = 0; ok && i < logical; i++) {
+		mbr ebr;
+		memset(&ebr, 0, sizeof(mbr));
+		// Partición lógica relativa a su EBR y enlace relativo a la extendida
+		set_partition(&ebr.partition_table[0], i % 2 ? 0x82 : 0x83, 63, block - 63);
+		if (i + 1 < logical) {
+			set_partition(&ebr.partition_table[1], 0x05, (unsigned int)(i + 1) * block, block);
+		} else if (loop && logical > 1) {
+			set_partition(&ebr.partition_table[1], 0x05, block, block);
+		}
+		ebr.signature = 0xAA55;
+		ok = put(fd, (unsigned long long)(ext_start + (unsigned int)i * block) * SECTOR_SIZE, &ebr, sizeof(mbr));
+	}
+	return finish_image(fd, name, ok);
+}
+
+/**
+ * @brief Genera una imagen GPT con sus tablas primaria y de respaldo.
+ *
+ * @param dir Directorio de destino.
+ * @param name Nombre de la imagen.
+ * @param sector_size Tamaño de sector lógico.
+ * @param sectors Tamaño de la imagen en sectores.
+ * @param entries Cantidad de descriptores del arreglo.
+ * @param used Descriptores ocupados (los primeros del arreglo).
+ * @param corruption Daño que se aplica a la tabla primaria.
+ * @return int 1 si la imagen se escribió, 0 en caso de error.
+ */
+static int write_gpt_image(const char *dir, const char *name, unsigned int sector_size,
+		unsigned long long sectors, unsigned int entries, unsigned int used, gpt_corruption corruption) {
+	size_t array_bytes = (size_t)entries * sizeof(gpt_partition_descriptor);
+	unsigned long long array_sectors = (array_bytes + sector_size - 1) / sector_size;
+	unsigned long long first_usable = 2 + array_sectors;
+	unsigned long long last_usable = sectors - 2 - array_sectors;
+	unsigned long long part_sectors = (last_usable - first_usable + 1) / (used > 0 ? used : 1);
+	char *sector = (char *)calloc(1, sector_size);
+	unsigned char *array = (unsigned char *)calloc(array_sectors, sector_size);
+	gpt_header hdr;
+	mbr protective;
+	int ok = 0;
+	int fd;
+
+	if (sector == NULL || array == NULL || (fd = create_image(dir, name, sectors * sector_size)) < 0) {
+		free(sector);
+		free(array);
+		return 0;
+	}
+
+	// MBR de protección que cubre todo el disco
+	memset(&protective, 0, sizeof(mbr));
+	set_partition(&protective.partition_table[0], 0xEE, 1,
+			sectors - 1 > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (unsigned int)(sectors - 1));
+	protective.signature = 0xAA55;
+
+	for (unsigned int i = 0; i < used; i++) {
+		gpt_partition_descriptor *desc = (gpt_partition_descriptor *)(array + (size_t)i * sizeof(gpt_partition_descriptor));
+		char label[36];
+		str_to_guid(bench_gpt_types[i % (sizeof(bench_gpt_types) / sizeof(bench_gpt_types[0]))],
+				&desc->partition_type_guid);
+		fill_random(desc->unique_partition_guid, sizeof(desc->unique_partition_guid));
+		desc->starting_lba = first_usable + (unsigned long long)i * part_sectors;
+		desc->ending_lba = desc->starting_lba + part_sectors - 1;
+		// Nombre en UTF-16LE
+		int len = snprintf(label, sizeof(label), "bench-%u", i);
+		for (int c = 0; c < len; c++) {
+			desc->partition_name[2 * c] = (unsigned char)label[c];
+		}
+	}
+
+	memset(&hdr, 0, sizeof(gpt_header));
+	hdr.signature = GPT_HEADER_SIGNATURE;
+	hdr.revision = 0x00010000;
+	hdr.header_size = 92;
+	hdr.my_lba = 1;
+	hdr.alternate_lba = sectors - 1;
+	hdr.first_usable_lba = first_usable;
+	hdr.last_usable_lba = last_usable;
+	fill_random(&hdr.disk_guid, sizeof(guid));
+	hdr.partition_entry_lba = 2;
+	hdr.num_partition_entries = entries;
+	hdr.size_partition_entry = sizeof(gpt_partition_descriptor);
+	hdr.partition_entry_array_crc32 = crc32_buf(array, array_bytes);
+
+	// Tabla de respaldo: arreglo antes de la cabecera, en el final del disco
+	gpt_header backup = hdr;
+	backup.my_lba = sectors - 1;
+	backup.alternate_lba = 1;
+	backup.partition_entry_lba = sectors - 1 - array_sectors;
+	backup.header_crc32 = crc32_buf(&backup, backup.header_size);
+	hdr.header_crc32 = crc32_buf(&hdr, hdr.header_size);
+
+	memcpy(sector, &backup, sizeof(gpt_header));
+	ok = put(fd, backup.partition_entry_lba * sector_size, array, array_sectors * sector_size)
+		&& put(fd, backup.my_lba * sector_size, sector, sector_size);
+
+	if (corruption == CORRUPT_HEADER) {
+		hdr.header_crc32 ^= 0xFFFFFFFFU;
+	} else if (corruption == CORRUPT_ENTRIES) {
+		array[0] ^= 0xFF;
+	}
+	memcpy(sector, &hdr, sizeof(gpt_header));
+	ok = ok && put(fd, 0, &protective, sizeof(mbr))
+		&& put(fd, sector_size, sector, sector_size)
+		&& put(fd, 2ULL * sector_size, array, array_sectors * sector_size);
+	ok = finish_image(fd, name, ok);
+
+	free(sector);
+	free(array);
+	return ok;
+}
+
+int main(int argc, char *argv[]) {
+	const char *dir;
+	int ok = 1;
+
+	if (argc != 2) {
+		fprintf(stderr, "Uso: %s <directorio>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	dir = argv[1];
+	if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+		perror(dir);
+		return EXIT_FAILURE;
+	}
+
+	ok &= write_mbr_image(dir, "mbr-primary.img", 0, 0);
+	ok &= write_mbr_image(dir, "mbr-ebr8.img", 8, 0);
+	ok &= write_mbr_image(dir, "mbr-ebr127.img", 127, 0);
+	ok &= write_mbr_image(dir, "mbr-ebr-loop.img", 4, 1);
+	ok &= write_gpt_image(dir, "gpt-128.img", 512, 262144, 128, 16, CORRUPT_NONE);
+	ok &= write_gpt_image(dir, "gpt-128-full.img", 512, 262144, 128, 128, CORRUPT_NONE);
+	ok &= write_gpt_image(dir, "gpt-16384.img", 512, 1048576, 16384, 4096, CORRUPT_NONE);
+	ok &= write_gpt_image(dir, "gpt-131072.img", 512, 4194304, 131072, 131072, CORRUPT_NONE);
+	ok &= write_gpt_image(dir, "gpt-4kn.img", 4096, 65536, 128, 16, CORRUPT_NONE);
+	ok &= write_gpt_image(dir, "gpt-bad-header.img", 512, 262144, 128, 16, CORRUPT_HEADER);
+	ok &= write_gpt_image(dir, "gpt-bad-entries.img", 512, 262144, 128, 16, CORRUPT_ENTRIES);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,345 @@
+/**
+ * @file cache.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include "cache.h"
+#include "crc32.h"
+
+/**
+ * @struct cache_header
+ * @brief Encabezado de una entrada, seguido del resultado y de las particiones.
+ */
+typedef struct {
+	char magic[8];                ///< "LPCACHE" y '\0'.
+	unsigned int version;         ///< CACHE_VERSION.
+	unsigned int result_size;     ///< sizeof(listpart_result) del programa que escribió la entrada.
+	unsigned int partition_size;  ///< sizeof(listpart_partition) del programa que escribió la entrada.
+	unsigned int sector_size;     ///< Tamaño de sector lógico al guardar.
+	unsigned int lba0_crc32;      ///< CRC32 del primer sector.
+	unsigned int lba1_crc32;      ///< CRC32 del segundo sector (cabecera GPT).
+	unsigned int total;           ///< Particiones guardadas.
+	unsigned int ebr_count;       ///< Validadores de EBR que siguen al encabezado.
+} cache_header;
+
+/**
+ * @struct cache_ebr
+ * @brief Sector de la cadena EBR y su CRC32 al guardar la entrada.
+ */
+typedef struct {
+	unsigned long long lba;
+	unsigned int crc32;
+} cache_ebr;
+
+static const char cache_magic[8] = "LPCACHE";
+
+/**
+ * @brief Crea un directorio y los que le faltan en la ruta.
+ */
+static int make_dirs(char *path) {
+	for (char *p = path + 1; *p != '\0'; p++) {
+		if (*p != '/') {
+			continue;
+		}
+		*p = '\0';
+		int ok = mkdir(path, 0700) == 0 || errno == EEXIST;
+		*p = '/';
+		if (!ok) {
+			return 0;
+		}
+	}
+	return mkdir(path, 0700) == 0 || errno == EEXIST;
+}
+
+int cache_dir(char dir[CACHE_PATH_LEN]) {
+	const char *env;
+	int n;
+
+	if ((env = getenv("LISTPART_CACHE_DIR")) != NULL && env[0] != '\0') {
+		n = snprintf(dir, CACHE_PATH_LEN, "%s", env);
+	} else if ((env = getenv("XDG_CACHE_HOME")) != NULL && env[0] != '\0') {
+		n = snprintf(dir, CACHE_PATH_LEN, "%s/listpart", env);
+	} else if ((env = getenv("HOME")) != NULL && env[0] != '\0') {
+		n = snprintf(dir, CACHE_PATH_LEN, "%s/.cache/listpart", env);
+	} else {
+		return 0;
+	}
+	return n > 0 && n < CACHE_PATH_LEN && make_dirs(dir);
+}
+
+/**
+ * @brief Arma la ruta de la entrada a partir de la identidad del dispositivo.
+ *
+ * El nombre empieza con el dispositivo (número mayor:menor, o dispositivo e
+ * inodo de la imagen) y sigue con lo que cambia cuando se modifica (tamaño y
+ * fecha de modificación).
+ *
+ * @param name Si no es NULL, recibe la posición del nombre dentro de `path`.
+ * @param prefix Si no es NULL, recibe la longitud de la parte del nombre
+ *               que identifica al dispositivo.
+ * @return int 1 si el dispositivo tiene identidad (dispositivo de bloque o
+ *         archivo regular), 0 en caso contrario.
+ */
+static int entry_path(const char *dir, disk_handle *disk, char path[CACHE_PATH_LEN], size_t *name, size_t *prefix) {
+	struct stat st;
+	int base, id, n;
+
+	if (disk->fd < 0 || fstat(disk->fd, &st) != 0) {
+		return 0;
+	}
+	if (S_ISBLK(st.st_mode)) {
+		n = snprintf(path, CACHE_PATH_LEN, "%s/%nb-%u-%u-%n%llu", dir, &base, major(st.st_rdev),
+				minor(st.st_rdev), &id, disk->size_bytes);
+	} else if (S_ISREG(st.st_mode)) {
+		n = snprintf(path, CACHE_PATH_LEN, "%s/%nf-%llx-%llu-%n%lld.%09ld-%llu", dir, &base,
+				(unsigned long long)st.st_dev, (unsigned long long)st.st_ino, &id,
+				(long long)st.st_mtim.tv_sec, st.st_mtim.tv_nsec, (unsigned long long)st.st_size);
+	} else {
+		return 0;
+	}
+	if (n <= 0 || n >= CACHE_PATH_LEN) {
+		return 0;
+	}
+	if (name != NULL) {
+		*name = (size_t)base;
+	}
+	if (prefix != NULL) {
+		*prefix = (size_t)(id - base);
+	}
+	return 1;
+}
+
+/**
+ * @brief Elimina las entradas anteriores del mismo dispositivo.
+ *
+ * Una imagen modificada o un dispositivo que cambió de tamaño reciben una
+ * entrada nueva; las anteriores ya no pueden acertar y se borran para que
+ * el directorio no crezca.
+ *
+ * @param dir Directorio de la caché.
+ * @param name Nombre de la entrada vigente.
+ * @param prefix Longitud de la parte de `name` que identifica al dispositivo.
+ */
+static void remove_stale(const char *dir, const char *name, size_t prefix) {
+	char path[CACHE_PATH_LEN];
+	size_t len = strlen(name);
+	struct dirent *ent;
+	DIR *d;
+
+	if ((d = opendir(dir)) == NULL) {
+		return;
+	}
+	while ((ent = readdir(d)) != NULL) {
+		// Se conservan la entrada vigente y sus temporales (nombre.XXXXXX)
+		if (strncmp(ent->d_name, name, prefix) != 0 || strncmp(ent->d_name, name, len) == 0) {
+			continue;
+		}
+		int n = snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+		if (n > 0 && n < (int)sizeof(path)) {
+			unlink(path);
+		}
+	}
+	closedir(d);
+}
+
+/**
+ * @brief Calcula el CRC32 de los dos primeros sectores del disco.
+ *
+ * Un disco de un solo sector usa 0 como CRC32 del segundo.
+ */
+static int read_validators(disk_handle *disk, unsigned int *lba0, unsigned int *lba1) {
+	char sectors[2 * DISK_MAX_SECTOR_SIZE];
+
+	// Una sola lectura para el MBR y la cabecera GPT
+	if (disk_read(disk, 0, 2, sectors)) {
+		*lba0 = crc32_buf(sectors, disk->sector_size);
+		*lba1 = crc32_buf(sectors + disk->sector_size, disk->sector_size);
+		return 1;
+	}
+	if (read_lba_sector(disk, 0, sectors)) {
+		*lba0 = crc32_buf(sectors, disk->sector_size);
+		*lba1 = 0;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Indica el EBR del que depende una partición, si lo hay.
+ *
+ * Una partición extendida depende del primer EBR de su cadena, que está en
+ * su LBA inicial; una lógica, del EBR que la describe.
+ */
+static int partition_ebr(const listpart_partition *part, unsigned long long *lba) {
+	if (part->extended) {
+		*lba = part->start_lba;
+		return 1;
+	}
+	if (part->logical) {
+		*lba = part->ebr_lba;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Comprueba que los EBR guardados en la entrada no cambiaron.
+ */
+static int check_ebrs(disk_handle *disk, FILE *f, unsigned int count) {
+	char sector[DISK_MAX_SECTOR_SIZE];
+	cache_ebr ebr;
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (fread(&ebr, sizeof(ebr), 1, f) != 1 || !read_lba_sector(disk, ebr.lba, sector)
+				|| crc32_buf(sector, disk->sector_size) != ebr.crc32) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int cache_load(const char *dir, disk_handle *disk, listpart_result *result) {
+	char path[CACHE_PATH_LEN];
+	cache_header hdr;
+	listpart_result stored;
+	unsigned int lba0, lba1;
+	FILE *f;
+	int ok;
+
+	if (!entry_path(dir, disk, path, NULL, NULL)) {
+		return 0;
+	}
+	if ((f = fopen(path, "rb")) == NULL) {
+		return 0;
+	}
+	ok = fread(&hdr, sizeof(hdr), 1, f) == 1
+		&& memcmp(hdr.magic, cache_magic, sizeof(cache_magic)) == 0
+		&& hdr.version == CACHE_VERSION
+		&& hdr.result_size == sizeof(listpart_result)
+		&& hdr.partition_size == sizeof(listpart_partition)
+		&& hdr.sector_size == disk->sector_size
+		&& read_validators(disk, &lba0, &lba1)
+		&& hdr.lba0_crc32 == lba0 && hdr.lba1_crc32 == lba1
+		&& check_ebrs(disk, f, hdr.ebr_count)
+		&& fread(&stored, sizeof(stored), 1, f) == 1;
+	if (!ok) {
+		fclose(f);
+		return 0;
+	}
+
+	unsigned int count = hdr.total < result->capacity ? hdr.total : result->capacity;
+	if (fread(result->partitions, sizeof(listpart_partition), count, f) != count) {
+		fclose(f);
+		listpart_result_init(result, result->partitions, result->capacity);
+		return 0;
+	}
+	fclose(f);
+
+	// Los punteros no se guardan: se vuelven a asociar con las tablas de la biblioteca
+	stored.partitions = result->partitions;
+	stored.capacity = result->capacity;
+	stored.count = count;
+	stored.total = hdr.total;
+	stored.error = NULL;
+	*result = stored;
+	for (unsigned int i = 0; i < count; i++) {
+		listpart_partition *part = &result->partitions[i];
+		if (result->scheme == LISTPART_SCHEME_GPT) {
+			const gpt_partition_type *type = gpt_partition_type_by_guid(&part->type_guid);
+			part->type_name = type->description;
+			part->type_os = type->os;
+		} else {
+			part->type_name = mbr_partition_type_name(part->mbr_type);
+			part->type_os = NULL;
+		}
+		memset(&part->fs, 0, sizeof(fsprobe_info));
+	}
+	return 1;
+}
+
+int cache_store(const char *dir, disk_handle *disk, const listpart_result *result) {
+	char path[CACHE_PATH_LEN];
+	char tmp[CACHE_PATH_LEN + 8];
+	char sector[DISK_MAX_SECTOR_SIZE];
+	size_t name, prefix;
+	cache_header hdr;
+	cache_ebr ebr;
+	unsigned long long lba;
+	listpart_result stored = *result;
+	int fd;
+	FILE *f;
+	int ok;
+
+	if (result->error != NULL || result->count != result->total || !entry_path(dir, disk, path, &name, &prefix)) {
+		return 0;
+	}
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, cache_magic, sizeof(cache_magic));
+	hdr.version = CACHE_VERSION;
+	hdr.result_size = sizeof(listpart_result);
+	hdr.partition_size = sizeof(listpart_partition);
+	hdr.sector_size = disk->sector_size;
+	hdr.total = result->total;
+	if (!read_validators(disk, &hdr.lba0_crc32, &hdr.lba1_crc32)) {
+		return 0;
+	}
+	for (unsigned int i = 0; i < result->count; i++) {
+		hdr.ebr_count += (unsigned int)partition_ebr(&result->partitions[i], &lba);
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+	if ((fd = mkstemp(tmp)) < 0) {
+		return 0;
+	}
+	if ((f = fdopen(fd, "wb")) == NULL) {
+		close(fd);
+		unlink(tmp);
+		return 0;
+	}
+	stored.partitions = NULL;
+	stored.error = NULL;
+	ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+	for (unsigned int i = 0; ok && i < result->count; i++) {
+		if (!partition_ebr(&result->partitions[i], &lba)) {
+			continue;
+		}
+		memset(&ebr, 0, sizeof(ebr));
+		ebr.lba = lba;
+		ok = read_lba_sector(disk, lba, sector);
+		ebr.crc32 = ok ? crc32_buf(sector, disk->sector_size) : 0;
+		ok = ok && fwrite(&ebr, sizeof(ebr), 1, f) == 1;
+	}
+	ok = ok && fwrite(&stored, sizeof(stored), 1, f) == 1;
+	for (unsigned int i = 0; ok && i < result->count; i++) {
+		listpart_partition part = result->partitions[i];
+		part.type_name = NULL;
+		part.type_os = NULL;
+		memset(&part.fs, 0, sizeof(fsprobe_info));
+		ok = fwrite(&part, sizeof(part), 1, f) == 1;
+	}
+	ok = fclose(f) == 0 && ok;
+	if (!ok || rename(tmp, path) != 0) {
+		unlink(tmp);
+		return 0;
+	}
+	remove_stale(dir, path + name, prefix);
+	return 1;
+}
+
+int cache_invalidate(const char *dir, disk_handle *disk) {
+	char path[CACHE_PATH_LEN];
+
+	if (!entry_path(dir, disk, path, NULL, NULL)) {
+		return 1;
+	}
+	return unlink(path) == 0 || errno == ENOENT;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file cache.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Caché en disco de los resultados del análisis.
+ *
+ * Cada entrada guarda el resultado de listpart_parse_disk() de un
+ * dispositivo. La clave identifica al dispositivo: número mayor:menor y
+ * tamaño en los dispositivos de bloque; dispositivo, inodo, fecha de
+ * modificación y tamaño en las imágenes. Antes de usar una entrada se
+ * vuelven a leer los dos primeros sectores (MBR y cabecera GPT, con su CRC32)
+ * y los EBR de los que dependen las particiones extendidas y lógicas, y se
+ * comparan con los que había al guardarla, de modo que un acierto cuesta
+ * unas pocas lecturas pequeñas y la apertura de un archivo. Los EBR sin
+ * partición lógica en medio de la cadena no forman parte del resultado y no
+ * se comparan.
+ *
+ * Las entradas son archivos binarios propios de la versión del programa que
+ * las escribió: si cambia el formato o el tamaño de las estructuras se
+ * descartan.
+ * @copyright MIT License
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "listpart.h"
+
+/**
+ * @def CACHE_VERSION
+ * @brief Versión del formato de las entradas.
+ */
+#define CACHE_VERSION 4
+
+/**
+ * @def CACHE_PATH_LEN
+ * @brief Capacidad de las rutas del directorio y de las entradas.
+ */
+#define CACHE_PATH_LEN 4096
+
+/**
+ * @brief Determina el directorio de la caché y lo crea si no existe.
+ *
+ * Usa `LISTPART_CACHE_DIR` si está definida; si no,
+ * `$XDG_CACHE_HOME/listpart` o `$HOME/.cache/listpart`.
+ *
+ * @param dir Ruta del directorio.
+ * @return int 1 si el directorio está disponible, 0 en caso contrario.
+ */
+int cache_dir(char dir[CACHE_PATH_LEN]);
+
+/**
+ * @brief Carga el resultado guardado para un dispositivo, si sigue vigente.
+ *
+ * @param dir Directorio de la caché.
+ * @param disk Dispositivo abierto con disk_open().
+ * @param result Resultado preparado con listpart_result_init(); las
+ *               particiones se copian al arreglo del llamador, como en
+ *               listpart_parse_disk(). Los campos `fs` quedan vacíos.
+ * @return int 1 si hubo un acierto, 0 si no hay entrada o ya no es válida.
+ */
+int cache_load(const char *dir, disk_handle *disk, listpart_result *result);
+
+/**
+ * @brief Guarda el resultado de un dispositivo.
+ *
+ * La entrada se escribe en un archivo temporal que luego se renombra, de
+ * modo que otro proceso nunca lee una entrada incompleta. Después se
+ * eliminan las entradas anteriores del mismo dispositivo (las de otra fecha
+ * de modificación o de otro tamaño).
+ *
+ * @param dir Directorio de la caché.
+ * @param disk Dispositivo analizado.
+ * @param result Resultado completo (`count == total`) y sin error.
+ * @return int 1 si se guardó, 0 en caso contrario.
+ */
+int cache_store(const char *dir, disk_handle *disk, const listpart_result *result);
+
+/**
+ * @brief Elimina la entrada de un dispositivo.
+ *
+ * @return int 1 si no queda entrada para el dispositivo, 0 si no se pudo eliminar.
+ */
+int cache_invalidate(const char *dir, disk_handle *disk);
+
+#endif
@@ -0,0 +1,626 @@
+/**
+ * @file compress.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <dlfcn.h>
+#include <errno.h>
+#include <lzma.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "compress.h"
+
+/** @brief Número mágico del pie de la tabla de saltos de zstd "seekable". */
+#define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1u
+/** @brief Número mágico del frame omitible que contiene la tabla de saltos. */
+#define ZSTD_SEEKABLE_FRAME 0x184D2A5Eu
+/** @brief Bytes del pie de la tabla de saltos: frames, descriptor y número mágico. */
+#define ZSTD_SEEKABLE_FOOTER 9
+/** @brief Límite de frames de la tabla de saltos que se acepta. */
+#define ZSTD_SEEKABLE_MAX_FRAMES (1u << 24)
+/** @brief Valores de ZSTD_getFrameContentSize() sin tamaño. */
+#define ZSTD_CONTENTSIZE_UNKNOWN (0ULL - 1)
+#define ZSTD_CONTENTSIZE_ERROR (0ULL - 2)
+/** @brief ZSTD_reset_session_only de ZSTD_DCtx_reset(). */
+#define ZSTD_RESET_SESSION 1
+
+/**
+ * @enum compress_format
+ * @brief Formato de compresión de la imagen.
+ */
+typedef enum {
+	COMPRESS_GZIP = 0,
+	COMPRESS_XZ = 1,
+	COMPRESS_ZSTD = 2
+} compress_format;
+
+/**
+ * @struct compress_point
+ * @brief Lugar del archivo donde se puede empezar a descomprimir.
+ */
+typedef struct {
+	unsigned long long file_offset; ///< Desplazamiento en el archivo comprimido.
+	unsigned long long data_offset; ///< Desplazamiento en el disco descomprimido.
+} compress_point;
+
+/** @brief Buffers de entrada y salida de ZSTD_decompressStream(). */
+typedef struct {
+	const void *src;
+	size_t size;
+	size_t pos;
+} zstd_in;
+
+typedef struct {
+	void *dst;
+	size_t size;
+	size_t pos;
+} zstd_out;
+
+/** @brief Funciones de libzstd que se cargan en tiempo de ejecución. */
+static struct {
+	void *(*create)(void);
+	size_t (*free_ctx)(void *ctx);
+	size_t (*reset)(void *ctx, int directive);
+	size_t (*decompress)(void *ctx, zstd_out *out, zstd_in *in);
+	unsigned (*is_error)(size_t code);
+	unsigned long long (*content_size)(const void *src, size_t size);
+	int loaded;
+} zstd;
+
+static pthread_once_t zstd_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @struct compress_stream
+ * @brief Estado de la descompresión de una imagen.
+ */
+typedef struct {
+	compress_format format;
+	int fd;
+	const char *path;
+	unsigned long long file_size;
+	unsigned char in[COMPRESS_INPUT_SIZE]; ///< Datos comprimidos leídos.
+	size_t in_pos;                         ///< Primer byte de `in` aún no consumido.
+	size_t in_len;                         ///< Bytes válidos en `in`.
+	unsigned long long file_pos;           ///< Siguiente byte del archivo a leer.
+	int in_eof;                            ///< 1 si se alcanzó el fin del archivo.
+	unsigned long long pos;                ///< Siguiente byte descomprimido que se producirá.
+	unsigned long long win_start;          ///< Primer byte descomprimido que sigue en `window`.
+	unsigned char *window;                 ///< Últimos bytes descomprimidos (circular).
+	unsigned char *head;                   ///< Comienzo del disco.
+	unsigned long long head_len;           ///< Bytes válidos en `head`.
+	compress_point *points;                ///< Puntos de inicio, ordenados.
+	size_t npoints;
+	size_t point;                          ///< Punto desde el que se descomprime.
+	int blocks;                            ///< xz: 1 si se descomprime bloque a bloque con el índice.
+	int frame_done;                        ///< zstd: 1 si el último frame terminó.
+	z_stream zs;
+	lzma_stream xs;
+	lzma_block block;
+	lzma_filter filters[LZMA_FILTERS_MAX + 1];
+	lzma_check check;
+	void *zd;
+} compress_stream;
+
+static unsigned int le32(const unsigned char *p) {
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void zstd_load(void) {
+	void *lib = dlopen("libzstd.so.1", RTLD_NOW | RTLD_LOCAL);
+	if (lib == NULL) {
+		return;
+	}
+	*(void **)&zstd.create = dlsym(lib, "ZSTD_createDCtx");
+	*(void **)&zstd.free_ctx = dlsym(lib, "ZSTD_freeDCtx");
+	*(void **)&zstd.reset = dlsym(lib, "ZSTD_DCtx_reset");
+	*(void **)&zstd.decompress = dlsym(lib, "ZSTD_decompressStream");
+	*(void **)&zstd.is_error = dlsym(lib, "ZSTD_isError");
+	*(void **)&zstd.content_size = dlsym(lib, "ZSTD_getFrameContentSize");
+	zstd.loaded = zstd.create && zstd.free_ctx && zstd.reset && zstd.decompress && zstd.is_error && zstd.content_size;
+}
+
+/**
+ * @brief Lee `size` bytes en `offset` del archivo comprimido.
+ * @return 1 si se leyeron todos, 0 en caso contrario.
+ */
+static int read_at(int fd, void *buf, size_t size, unsigned long long offset) {
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = pread(fd, (char *)buf + done, size - done, (off_t)(offset + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return 0;
+		}
+		done += (size_t)n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Lee el siguiente tramo del archivo comprimido en `in`.
+ * @return Bytes leídos, 0 en el fin del archivo, -1 ante un error.
+ */
+static long refill(compress_stream *s) {
+	ssize_t n;
+	do {
+		n = pread(s->fd, s->in, sizeof(s->in), (off_t)s->file_pos);
+	} while (n < 0 && errno == EINTR);
+	if (n < 0) {
+		return -1;
+	}
+	s->in_pos = 0;
+	s->in_len = (size_t)n;
+	s->file_pos += (unsigned long long)n;
+	s->in_eof = n == 0;
+	return (long)n;
+}
+
+/**
+ * @brief Libera las opciones de los filtros de la cabecera del último bloque xz.
+ */
+static void free_filters(compress_stream *s) {
+	for (int i = 0; i < LZMA_FILTERS_MAX && s->filters[i].id != LZMA_VLI_UNKNOWN; i++) {
+		free(s->filters[i].options);
+		s->filters[i].options = NULL;
+	}
+	s->filters[0].id = LZMA_VLI_UNKNOWN;
+}
+
+/**
+ * @brief Prepara la descompresión del bloque xz `index` del índice.
+ */
+static int start_xz_block(compress_stream *s, size_t index) {
+	unsigned char hdr[LZMA_BLOCK_HEADER_SIZE_MAX];
+	unsigned long long offset = s->points[index].file_offset;
+
+	if (!read_at(s->fd, hdr, 1, offset) || hdr[0] == 0) {
+		return 0;
+	}
+	free_filters(s);
+	memset(&s->block, 0, sizeof(s->block));
+	s->block.version = 1;
+	s->block.check = s->check;
+	s->block.filters = s->filters;
+	s->block.header_size = lzma_block_header_size_decode(hdr[0]);
+	if (!read_at(s->fd, hdr, s->block.header_size, offset)
+			|| lzma_block_header_decode(&s->block, NULL, hdr) != LZMA_OK
+			|| lzma_block_decoder(&s->xs, &s->block) != LZMA_OK) {
+		return 0;
+	}
+	s->point = index;
+	s->file_pos = offset + s->block.header_size;
+	s->in_pos = s->in_len = 0;
+	s->in_eof = 0;
+	return 1;
+}
+
+/**
+ * @brief Vuelve a empezar la descompresión en el punto `index`.
+ *
+ * Se descarta lo que había en la ventana; el comienzo del disco se conserva.
+ */
+static int seek_point(compress_stream *s, size_t index) {
+	s->pos = s->points[index].data_offset;
+	s->win_start = s->pos;
+	s->point = index;
+	s->frame_done = 0;
+	if (s->format == COMPRESS_XZ && s->blocks) {
+		return start_xz_block(s, index);
+	}
+	s->file_pos = s->points[index].file_offset;
+	s->in_pos = s->in_len = 0;
+	s->in_eof = 0;
+	switch (s->format) {
+	case COMPRESS_GZIP:
+		return inflateReset(&s->zs) == Z_OK;
+	case COMPRESS_XZ:
+		return lzma_stream_decoder(&s->xs, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+	case COMPRESS_ZSTD:
+		return !zstd.is_error(zstd.reset(s->zd, ZSTD_RESET_SESSION));
+	}
+	return 0;
+}
+
+/**
+ * @brief Avanza un paso la descompresión con gzip.
+ * @return 1 para continuar, 0 en el fin de los datos, -1 ante un error.
+ */
+static int step_gzip(compress_stream *s, unsigned char *out, size_t len, size_t *done) {
+	int ret;
+
+	s->zs.next_in = s->in + s->in_pos;
+	s->zs.avail_in = (uInt)(s->in_len - s->in_pos);
+	s->zs.next_out = out + *done;
+	s->zs.avail_out = (uInt)(len - *done);
+	ret = inflate(&s->zs, Z_NO_FLUSH);
+	s->in_pos = s->in_len - s->zs.avail_in;
+	*done = len - s->zs.avail_out;
+	if (ret == Z_STREAM_END) {
+		// Puede seguir otro miembro gzip concatenado; lo demás se ignora
+		if (s->in_pos == s->in_len && refill(s) <= 0) {
+			return 0;
+		}
+		if (s->in[s->in_pos] != 0x1f) {
+			return 0;
+		}
+		return inflateReset(&s->zs) == Z_OK ? 1 : -1;
+	}
+	if (ret == Z_BUF_ERROR) {
+		return s->in_eof ? -1 : 1;
+	}
+	return ret == Z_OK ? 1 : -1;
+}
+
+/**
+ * @brief Avanza un paso la descompresión con xz.
+ */
+static int step_xz(compress_stream *s, unsigned char *out, size_t len, size_t *done) {
+	lzma_ret ret;
+
+	s->xs.next_in = s->in + s->in_pos;
+	s->xs.avail_in = s->in_len - s->in_pos;
+	s->xs.next_out = out + *done;
+	s->xs.avail_out = len - *done;
+	ret = lzma_code(&s->xs, s->in_eof ? LZMA_FINISH : LZMA_RUN);
+	s->in_pos = s->in_len - s->xs.avail_in;
+	*done = len - s->xs.avail_out;
+	if (ret == LZMA_STREAM_END) {
+		// Con índice cada bloque se descomprime por separado
+		if (s->blocks && s->point + 1 < s->npoints) {
+			return start_xz_block(s, s->point + 1) ? 1 : -1;
+		}
+		return 0;
+	}
+	if (ret == LZMA_BUF_ERROR) {
+		return s->in_eof ? -1 : 1;
+	}
+	return ret == LZMA_OK ? 1 : -1;
+}
+
+/**
+ * @brief Avanza un paso la descompresión con zstd.
+ */
+static int step_zstd(compress_stream *s, unsigned char *out, size_t len, size_t *done) {
+	zstd_in in = { s->in, s->in_len, s->in_pos };
+	zstd_out o = { out, len, *done };
+	size_t ret;
+
+	ret = zstd.decompress(s->zd, &o, &in);
+	s->in_pos = in.pos;
+	if (zstd.is_error(ret)) {
+		return -1;
+	}
+	s->frame_done = ret == 0;
+	if (s->in_eof && o.pos == *done) {
+		// Sin más entrada ni salida pendiente: el último frame debe haber terminado
+		return s->frame_done ? 0 : -1;
+	}
+	*done = o.pos;
+	return 1;
+}
+
+/**
+ * @brief Descomprime hasta `len` bytes en `out`.
+ * @return Bytes producidos, 0 en el fin de los datos, -1 ante un error.
+ */
+static long decode(compress_stream *s, unsigned char *out, size_t len) {
+	size_t done = 0;
+	int ret = 1;
+
+	while (done == 0 && ret > 0) {
+		if (s->in_pos == s->in_len && !s->in_eof && refill(s) < 0) {
+			return -1;
+		}
+		switch (s->format) {
+		case COMPRESS_GZIP:
+			ret = step_gzip(s, out, len, &done);
+			break;
+		case COMPRESS_XZ:
+			ret = step_xz(s, out, len, &done);
+			break;
+		case COMPRESS_ZSTD:
+			ret = step_zstd(s, out, len, &done);
+			break;
+		}
+	}
+	if (done > 0) {
+		return (long)done;
+	}
+	return ret;
+}
+
+/**
+ * @brief Descomprime el siguiente tramo en la ventana.
+ * @return 1 si se produjeron datos, 0 en el fin de los datos, -1 ante un error.
+ */
+static int produce(compress_stream *s) {
+	size_t offset = (size_t)(s->pos % COMPRESS_WINDOW_SIZE);
+	size_t want = COMPRESS_WINDOW_SIZE - offset;
+	long n;
+
+	if (want > 4 * COMPRESS_INPUT_SIZE) {
+		want = 4 * COMPRESS_INPUT_SIZE;
+	}
+	n = decode(s, s->window + offset, want);
+	if (n <= 0) {
+		return (int)n;
+	}
+	// Conservar el comienzo del disco si se está descomprimiendo desde allí
+	if (s->pos < COMPRESS_HEAD_SIZE && s->pos == s->head_len) {
+		size_t keep = COMPRESS_HEAD_SIZE - s->pos < (unsigned long long)n ? (size_t)(COMPRESS_HEAD_SIZE - s->pos) : (size_t)n;
+		memcpy(s->head + s->pos, s->window + offset, keep);
+		s->head_len += keep;
+	}
+	s->pos += (unsigned long long)n;
+	if (s->pos - s->win_start > COMPRESS_WINDOW_SIZE) {
+		s->win_start = s->pos - COMPRESS_WINDOW_SIZE;
+	}
+	return 1;
+}
+
+/**
+ * @brief Último punto de inicio anterior o igual a `offset`.
+ */
+static size_t find_point(const compress_stream *s, unsigned long long offset) {
+	size_t lo = 0, hi = s->npoints;
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (s->points[mid].data_offset <= offset) {
+			lo = mid;
+		} else {
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+static int compress_read(disk_image *img, char *buf, size_t size, unsigned long long offset) {
+	compress_stream *s = (compress_stream *)img->stream;
+
+	while (size > 0) {
+		size_t n;
+		if (offset < s->head_len) {
+			n = s->head_len - offset < size ? (size_t)(s->head_len - offset) : size;
+			memcpy(buf, s->head + offset, n);
+		} else if (offset >= s->win_start && offset < s->pos) {
+			size_t at = (size_t)(offset % COMPRESS_WINDOW_SIZE);
+			n = COMPRESS_WINDOW_SIZE - at;
+			if (s->pos - offset < n) {
+				n = (size_t)(s->pos - offset);
+			}
+			if (size < n) {
+				n = size;
+			}
+			memcpy(buf, s->window + at, n);
+		} else {
+			// Volver a un punto anterior si el dato ya salió de la ventana, o
+			// saltar hacia adelante si el índice lo permite
+			size_t point = find_point(s, offset);
+			if ((offset < s->win_start || s->points[point].data_offset > s->pos) && !seek_point(s, point)) {
+				fprintf(stderr, "Error: No se pudo reiniciar la descompresion de %s\n", s->path);
+				return 0;
+			}
+			int ret = produce(s);
+			if (ret < 0) {
+				fprintf(stderr, "Error: La imagen comprimida %s esta danada o truncada\n", s->path);
+			}
+			if (ret <= 0) {
+				return 0;
+			}
+			continue;
+		}
+		buf += n;
+		offset += n;
+		size -= n;
+	}
+	return 1;
+}
+
+static void compress_release(disk_image *img) {
+	compress_stream *s = (compress_stream *)img->stream;
+
+	if (s == NULL) {
+		return;
+	}
+	switch (s->format) {
+	case COMPRESS_GZIP:
+		inflateEnd(&s->zs);
+		break;
+	case COMPRESS_XZ:
+		lzma_end(&s->xs);
+		free_filters(s);
+		break;
+	case COMPRESS_ZSTD:
+		if (s->zd != NULL) {
+			zstd.free_ctx(s->zd);
+		}
+		break;
+	}
+	free(s->points);
+	free(s->window);
+	free(s->head);
+	free(s);
+	img->stream = NULL;
+}
+
+/**
+ * @brief Carga la tabla de saltos de zstd "seekable", si el archivo la tiene.
+ * @return 1 si se cargó, 0 si no hay tabla, -1 ante un error de memoria.
+ */
+static int load_zstd_seek_table(compress_stream *s, disk_image *img) {
+	unsigned char footer[ZSTD_SEEKABLE_FOOTER], frame[8], *table;
+	unsigned long long frames, entry, table_size, file = 0, data = 0;
+
+	if (s->file_size < ZSTD_SEEKABLE_FOOTER + 8
+			|| !read_at(s->fd, footer, sizeof(footer), s->file_size - ZSTD_SEEKABLE_FOOTER)
+			|| le32(footer + 5) != ZSTD_SEEKABLE_MAGIC || (footer[4] & 0x7C) != 0) {
+		return 0;
+	}
+	frames = le32(footer);
+	entry = (footer[4] & 0x80) ? 12 : 8; // con o sin suma de verificación
+	table_size = frames * entry + ZSTD_SEEKABLE_FOOTER;
+	if (frames == 0 || frames > ZSTD_SEEKABLE_MAX_FRAMES || table_size + 8 > s->file_size
+			|| !read_at(s->fd, frame, sizeof(frame), s->file_size - table_size - 8)
+			|| le32(frame) != ZSTD_SEEKABLE_FRAME || le32(frame + 4) != table_size) {
+		return 0;
+	}
+	table = (unsigned char *)malloc((size_t)(frames * entry));
+	s->points = (compress_point *)malloc((size_t)frames * sizeof(compress_point));
+	if (table == NULL || s->points == NULL) {
+		free(table);
+		return -1;
+	}
+	if (!read_at(s->fd, table, (size_t)(frames * entry), s->file_size - table_size)) {
+		free(table);
+		return 0;
+	}
+	for (unsigned long long i = 0; i < frames; i++) {
+		s->points[i].file_offset = file;
+		s->points[i].data_offset = data;
+		file += le32(table + i * entry);
+		data += le32(table + i * entry + 4);
+	}
+	free(table);
+	s->npoints = (size_t)frames;
+	img->size = data;
+	return 1;
+}
+
+/**
+ * @brief Carga el índice de bloques de un archivo xz de un solo flujo.
+ * @return 1 si se cargó, 0 si no hay índice utilizable, -1 ante un error de memoria.
+ */
+static int load_xz_index(compress_stream *s, disk_image *img) {
+	unsigned char footer[LZMA_STREAM_HEADER_SIZE], *buf;
+	lzma_stream_flags flags;
+	lzma_index *index = NULL;
+	lzma_index_iter iter;
+	uint64_t memlimit = UINT64_MAX;
+	size_t in_pos = 0, count = 0;
+
+	if (s->file_size < 2 * LZMA_STREAM_HEADER_SIZE
+			|| !read_at(s->fd, footer, sizeof(footer), s->file_size - LZMA_STREAM_HEADER_SIZE)
+			|| lzma_stream_footer_decode(&flags, footer) != LZMA_OK
+			|| flags.backward_size > s->file_size - 2 * LZMA_STREAM_HEADER_SIZE) {
+		return 0;
+	}
+	buf = (unsigned char *)malloc((size_t)flags.backward_size);
+	if (buf == NULL) {
+		return -1;
+	}
+	if (!read_at(s->fd, buf, (size_t)flags.backward_size, s->file_size - LZMA_STREAM_HEADER_SIZE - flags.backward_size)
+			|| lzma_index_buffer_decode(&index, &memlimit, NULL, buf, &in_pos, (size_t)flags.backward_size) != LZMA_OK) {
+		free(buf);
+		return 0;
+	}
+	free(buf);
+	// Varios flujos concatenados: el índice del último no describe el archivo
+	if (lzma_index_file_size(index) != s->file_size || lzma_index_block_count(index) == 0) {
+		lzma_index_end(index, NULL);
+		return 0;
+	}
+	s->points = (compress_point *)malloc((size_t)lzma_index_block_count(index) * sizeof(compress_point));
+	if (s->points == NULL) {
+		lzma_index_end(index, NULL);
+		return -1;
+	}
+	lzma_index_iter_init(&iter, index);
+	while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+		s->points[count].file_offset = iter.block.compressed_file_offset;
+		s->points[count].data_offset = iter.block.uncompressed_file_offset;
+		count++;
+	}
+	s->npoints = count;
+	s->check = flags.check;
+	s->blocks = 1;
+	img->size = lzma_index_uncompressed_size(index);
+	lzma_index_end(index, NULL);
+	return 1;
+}
+
+int compress_detect(const unsigned char *head, size_t len) {
+	if (len >= 2 && head[0] == 0x1f && head[1] == 0x8b) {
+		return 1;
+	}
+	if (len >= 6 && memcmp(head, "\xFD" "7zXZ\x00", 6) == 0) {
+		return 1;
+	}
+	// Frame zstd, o frame omitible (0x184D2A50 a 0x184D2A5F) al comienzo
+	return len >= 4 && (le32(head) == 0xFD2FB528u || (le32(head) & 0xFFFFFFF0u) == 0x184D2A50u);
+}
+
+int compress_open(disk_image *img, const char *path, const unsigned char *head, size_t len) {
+	compress_stream *s = (compress_stream *)calloc(1, sizeof(compress_stream));
+	int indexed = 0;
+
+	if (s == NULL) {
+		return -1;
+	}
+	img->stream = s;
+	img->release = compress_release;
+	s->fd = img->fd;
+	s->path = path;
+	s->file_size = img->file_size;
+	s->filters[0].id = LZMA_VLI_UNKNOWN;
+	s->window = (unsigned char *)malloc(COMPRESS_WINDOW_SIZE);
+	s->head = (unsigned char *)malloc(COMPRESS_HEAD_SIZE);
+	if (s->window == NULL || s->head == NULL) {
+		return -1;
+	}
+
+	if (head[0] == 0x1f) {
+		s->format = COMPRESS_GZIP;
+		img->format = "gzip";
+		if (inflateInit2(&s->zs, 15 + 16) != Z_OK) {
+			return -1;
+		}
+	} else if (head[0] == 0xFD) {
+		lzma_stream init = LZMA_STREAM_INIT;
+		s->format = COMPRESS_XZ;
+		s->xs = init;
+		img->format = "xz";
+		indexed = load_xz_index(s, img);
+	} else {
+		s->format = COMPRESS_ZSTD;
+		img->format = "zstd";
+		pthread_once(&zstd_once, zstd_load);
+		if (!zstd.loaded || (s->zd = zstd.create()) == NULL) {
+			fprintf(stderr, "Error: No se encontro libzstd para leer la imagen %s\n", path);
+			return -1;
+		}
+		indexed = load_zstd_seek_table(s, img);
+		if (indexed == 0 && le32(head) == 0xFD2FB528u) {
+			// Sin tabla de saltos, el tamaño es el que declara el primer frame, si lo hace
+			unsigned long long size = zstd.content_size(head, len);
+			if (size != ZSTD_CONTENTSIZE_UNKNOWN && size != ZSTD_CONTENTSIZE_ERROR) {
+				img->size = size;
+			}
+		}
+	}
+	if (indexed < 0) {
+		return -1;
+	}
+	if (indexed == 0) {
+		// Sin índice solo se puede empezar desde el comienzo del archivo
+		free(s->points);
+		s->points = (compress_point *)calloc(1, sizeof(compress_point));
+		if (s->points == NULL) {
+			return -1;
+		}
+		s->npoints = 1;
+		s->blocks = 0;
+	}
+	if (!seek_point(s, 0)) {
+		fprintf(stderr, "Error: No se pudo iniciar la descompresion de %s\n", path);
+		return -1;
+	}
+	img->read = compress_read;
+	return 1;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file compress.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Lectura de imágenes crudas comprimidas con gzip, xz o zstd.
+ *
+ * La imagen se descomprime en flujo y solo hasta el byte más alto que se
+ * lee: listar las particiones de un disco MBR o GPT descomprime unos pocos
+ * cientos de KB. Se conservan el comienzo del disco (COMPRESS_HEAD_SIZE
+ * bytes) y lo último que se descomprimió (COMPRESS_WINDOW_SIZE bytes), de
+ * modo que las lecturas hacia atrás dentro de esas zonas no descomprimen de
+ * nuevo.
+ *
+ * Cuando el archivo tiene un índice se puede empezar a descomprimir cerca
+ * del dato pedido y el tamaño del disco es conocido: la tabla de saltos del
+ * formato zstd "seekable" (un frame independiente por bloque) y el índice de
+ * bloques de xz (imágenes comprimidas con `xz -T`). Así la cabecera GPT de
+ * respaldo, al final del disco, se lee sin descomprimir todo lo anterior.
+ * Sin índice (gzip, zstd de un frame) el tamaño del disco se toma del
+ * encabezado del frame zstd si lo declara, o queda desconocido.
+ *
+ * zstd se carga en tiempo de ejecución (`libzstd.so.1`), por lo que no hace
+ * falta para compilar; si no está instalada, las imágenes zstd se rechazan.
+ * @copyright MIT License
+ */
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stddef.h>
+#include "image.h"
+
+/**
+ * @def COMPRESS_HEAD_SIZE
+ * @brief Bytes del comienzo del disco que se conservan descomprimidos.
+ */
+#define COMPRESS_HEAD_SIZE (1024 * 1024)
+
+/**
+ * @def COMPRESS_WINDOW_SIZE
+ * @brief Bytes descomprimidos más recientes que se conservan.
+ */
+#define COMPRESS_WINDOW_SIZE (1024 * 1024)
+
+/**
+ * @def COMPRESS_INPUT_SIZE
+ * @brief Tamaño de cada lectura del archivo comprimido.
+ */
+#define COMPRESS_INPUT_SIZE (64 * 1024)
+
+/**
+ * @brief Indica si un archivo empieza con la firma de gzip, xz o zstd.
+ *
+ * @param head Primeros bytes del archivo.
+ * @param len Cantidad de bytes de `head`.
+ * @return int 1 si el archivo está comprimido, 0 en caso contrario.
+ */
+int compress_detect(const unsigned char *head, size_t len);
+
+/**
+ * @brief Prepara la lectura de una imagen comprimida.
+ *
+ * Busca el índice del archivo, si lo tiene, y asocia a `img` la lectura en
+ * flujo (`img->read`).
+ *
+ * @param img Imagen con `fd` y `file_size` del archivo.
+ * @param path Ruta del archivo, para los mensajes de error.
+ * @param head Primeros bytes del archivo.
+ * @param len Cantidad de bytes de `head`.
+ * @return int 1 si la imagen quedó lista, -1 si no se puede leer (el error ya se informó).
+ */
+int compress_open(disk_image *img, const char *path, const unsigned char *head, size_t len);
+
+#endif
@@ -0,0 +1,230 @@
+/**
+ * @file crc32.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include "crc32.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32_HAVE_PCLMUL 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__GNUC__) && defined(__linux__)
+#define CRC32_HAVE_ARMV8 1
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/** @brief Polinomio CRC32 reflejado (IEEE 802.3). */
+#define CRC32_POLY 0xEDB88320u
+
+/** @brief Tablas slice-by-8: `crc32_table[k][b]` es el CRC de `b` seguido de k bytes en cero. */
+static uint32_t crc32_table[8][256];
+
+/** @brief Núcleo que procesa el estado interno (CRC invertido). */
+typedef uint32_t (*crc32_kernel)(uint32_t state, const unsigned char *buf, size_t len);
+
+static crc32_kernel crc32_selected;
+static const char *crc32_selected_name;
+static pthread_once_t crc32_once = PTHREAD_ONCE_INIT;
+
+static uint32_t crc32_slice8(uint32_t state, const unsigned char *buf, size_t len) {
+	// Avanzar byte a byte hasta alinear a 8
+	while (len > 0 && ((uintptr_t)buf & 7) != 0) {
+		state = crc32_table[0][(state ^ *buf++) & 0xff] ^ (state >> 8);
+		len--;
+	}
+	while (len >= 8) {
+		uint32_t lo, hi;
+		memcpy(&lo, buf, 4);
+		memcpy(&hi, buf + 4, 4);
+		lo ^= state;
+		state = crc32_table[7][lo & 0xff] ^ crc32_table[6][(lo >> 8) & 0xff]
+			^ crc32_table[5][(lo >> 16) & 0xff] ^ crc32_table[4][lo >> 24]
+			^ crc32_table[3][hi & 0xff] ^ crc32_table[2][(hi >> 8) & 0xff]
+			^ crc32_table[1][(hi >> 16) & 0xff] ^ crc32_table[0][hi >> 24];
+		buf += 8;
+		len -= 8;
+	}
+	while (len > 0) {
+		state = crc32_table[0][(state ^ *buf++) & 0xff] ^ (state >> 8);
+		len--;
+	}
+	return state;
+}
+
+#ifdef CRC32_HAVE_PCLMUL
+
+/**
+ * @brief Plegado de 64 bytes por iteración con multiplicación sin acarreo.
+ *
+ * Sigue el método de Intel "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction", con las constantes del dominio reflejado
+ * para el polinomio IEEE. Requiere `len >= 64` y múltiplo de 16.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32_pclmul_fold(uint32_t state, const unsigned char *buf, size_t len) {
+	static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442bd4, 0x01c6e41596 };
+	static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997d0, 0x00ccaa009e };
+	static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163cd6124, 0x0000000000 };
+	static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01db710641, 0x01f7011641 };
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+	x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+	x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+	x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+	x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)state));
+	x0 = _mm_load_si128((const __m128i *)k1k2);
+	buf += 64;
+	len -= 64;
+
+	// Cuatro plegados en paralelo por cada bloque de 64 bytes
+	while (len >= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+		y5 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+		y6 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+		y7 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+		y8 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+		buf += 64;
+		len -= 64;
+	}
+
+	// Reducir los cuatro acumuladores a 128 bits
+	x0 = _mm_load_si128((const __m128i *)k3k4);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Bloques restantes de 16 bytes
+	while (len >= 16) {
+		x2 = _mm_loadu_si128((const __m128i *)buf);
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+		buf += 16;
+		len -= 16;
+	}
+
+	// De 128 a 64 bits
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_srli_si128(x1, 8);
+	x1 = _mm_xor_si128(x1, x2);
+	x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Reducción de Barrett a 32 bits
+	x0 = _mm_load_si128((const __m128i *)poly);
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+static uint32_t crc32_pclmul(uint32_t state, const unsigned char *buf, size_t len) {
+	if (len >= 64) {
+		size_t chunk = len & ~(size_t)15;
+		state = crc32_pclmul_fold(state, buf, chunk);
+		buf += chunk;
+		len -= chunk;
+	}
+	return crc32_slice8(state, buf, len);
+}
+
+#endif
+
+#ifdef CRC32_HAVE_ARMV8
+
+__attribute__((target("+crc")))
+static uint32_t crc32_armv8(uint32_t state, const unsigned char *buf, size_t len) {
+	while (len >= 8) {
+		uint64_t v;
+		memcpy(&v, buf, 8);
+		state = __crc32d(state, v);
+		buf += 8;
+		len -= 8;
+	}
+	while (len > 0) {
+		state = __crc32b(state, *buf++);
+		len--;
+	}
+	return state;
+}
+
+#endif
+
+// Genera las tablas y elige el núcleo más rápido disponible
+static void crc32_init(void) {
+	for (uint32_t b = 0; b < 256; b++) {
+		uint32_t c = b;
+		for (int k = 0; k < 8; k++) {
+			c = (c & 1) ? (c >> 1) ^ CRC32_POLY : c >> 1;
+		}
+		crc32_table[0][b] = c;
+	}
+	for (uint32_t b = 0; b < 256; b++) {
+		for (int t = 1; t < 8; t++) {
+			uint32_t prev = crc32_table[t - 1][b];
+			crc32_table[t][b] = crc32_table[0][prev & 0xff] ^ (prev >> 8);
+		}
+	}
+
+	crc32_selected = crc32_slice8;
+	crc32_selected_name = "slice-by-8";
+#ifdef CRC32_HAVE_PCLMUL
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")) {
+		crc32_selected = crc32_pclmul;
+		crc32_selected_name = "pclmul";
+	}
+#endif
+#ifdef CRC32_HAVE_ARMV8
+	if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+		crc32_selected = crc32_armv8;
+		crc32_selected_name = "armv8";
+	}
+#endif
+}
+
+unsigned int crc32_update(unsigned int crc, const void *buf, size_t len) {
+	pthread_once(&crc32_once, crc32_init);
+	return ~crc32_selected(~(uint32_t)crc, (const unsigned char *)buf, len);
+}
+
+unsigned int crc32_buf(const void *buf, size_t len) {
+	return crc32_update(0, buf, len);
+}
+
+const char *crc32_impl_name(void) {
+	pthread_once(&crc32_once, crc32_init);
+	return crc32_selected_name;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file crc32.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief CRC32 (polinomio IEEE 802.3, el usado por GPT).
+ *
+ * La implementación portable procesa 8 bytes por iteración con tablas
+ * (slice-by-8). En tiempo de ejecución se elige, si el procesador lo
+ * permite, un núcleo acelerado: plegado con PCLMULQDQ en x86-64 o las
+ * instrucciones CRC32 de ARMv8.
+ * @copyright MIT License
+ */
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+
+/**
+ * @brief Continúa el cálculo de un CRC32 con más datos.
+ *
+ * @param crc CRC32 de los datos anteriores (0 para empezar).
+ * @param buf Datos a procesar.
+ * @param len Cantidad de bytes.
+ * @return CRC32 de los datos anteriores seguidos de `buf`.
+ */
+unsigned int crc32_update(unsigned int crc, const void *buf, size_t len);
+
+/**
+ * @brief Calcula el CRC32 de un buffer.
+ *
+ * @param buf Datos a procesar.
+ * @param len Cantidad de bytes.
+ * @return CRC32 de los datos.
+ */
+unsigned int crc32_buf(const void *buf, size_t len);
+
+/**
+ * @brief Nombre del núcleo elegido para este procesador.
+ *
+ * @return "pclmul", "armv8" o "slice-by-8".
+ */
+const char *crc32_impl_name(void);
+
+#endif
@@ -0,0 +1,657 @@
+/**
+ * @file disk.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#define _GNU_SOURCE // O_DIRECT
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#include "disk.h"
+#include "image.h"
+#include "stats.h"
+#include "uring.h"
+
+static int in_window(disk_handle *disk, unsigned long long lba, unsigned long long count);
+static int pread_full(int fd, char *buf, size_t size, unsigned long long offset);
+static int disk_pread(disk_handle *disk, char *buf, size_t size, unsigned long long offset);
+static int disk_direct(disk_handle *disk, unsigned int align);
+static int disk_open_device(disk_handle *disk, const char *path, int flags);
+
+/**
+ * @brief Indica si `size` es un tamaño de sector soportado.
+ */
+static int valid_sector_size(unsigned int size) {
+	return size >= SECTOR_SIZE && size <= DISK_MAX_SECTOR_SIZE && (size & (size - 1)) == 0;
+}
+
+/**
+ * @brief Detecta el tamaño de sector de una imagen buscando la cabecera GPT.
+ *
+ * La cabecera GPT está en el LBA 1, es decir en el byte 512 o en el 4096.
+ */
+static unsigned int probe_image_sector_size(disk_handle *disk) {
+	static const unsigned int sizes[] = { 512, 4096 };
+	char signature[8];
+
+	for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		if (disk_pread(disk, signature, sizeof(signature), sizes[i])
+				&& memcmp(signature, "EFI PART", sizeof(signature)) == 0) {
+			return sizes[i];
+		}
+	}
+	return SECTOR_SIZE;
+}
+
+/**
+ * @brief Proyecta una imagen en memoria para leerla sin copias.
+ *
+ * Los accesos a la tabla de particiones son dispersos, por lo que se
+ * desactiva la lectura anticipada secuencial (MADV_RANDOM); las regiones
+ * que se necesitan se piden luego con disk_prefetch(). Si la proyección no
+ * es posible, la imagen se lee con lecturas posicionadas.
+ */
+static void disk_map_image(disk_handle *disk) {
+	if (disk->size_bytes == 0 || disk->size_bytes > SIZE_MAX) {
+		return;
+	}
+	void *map = mmap(NULL, (size_t)disk->size_bytes, PROT_READ, MAP_SHARED, disk->fd, 0);
+	if (map == MAP_FAILED) {
+		return;
+	}
+#ifdef MADV_RANDOM
+	madvise(map, (size_t)disk->size_bytes, MADV_RANDOM);
+#endif
+	disk->memory = (const char *)map;
+	disk->mapped = 1;
+}
+
+int disk_open(disk_handle *disk, const char *path) {
+	return disk_open_flags(disk, path, 0);
+}
+
+int disk_open_flags(disk_handle *disk, const char *path, int flags) {
+	unsigned long long start = stats_begin();
+	int ok = disk_open_device(disk, path, flags);
+
+	stats_end(STATS_OPEN, start, 0);
+	return ok;
+}
+
+/**
+ * @brief Abre el dispositivo y prepara el manejador (ver disk_open_flags()).
+ */
+static int disk_open_device(disk_handle *disk, const char *path, int flags) {
+	memset(disk, 0, sizeof(disk_handle));
+	disk->path = path;
+	disk->sector_size = SECTOR_SIZE;
+	disk->physical_sector_size = SECTOR_SIZE;
+
+	//ABRIR EL DISPOSITIVO EN MODO LECTURA
+	disk->fd = open(path, O_RDONLY);
+	if (disk->fd < 0) {
+		fprintf(stderr, "Error: No se pudo abrir el archivo o dispositivo %s\n", path);
+		return 0;
+	}
+
+	// Determinar el tamaño total y el tamaño de sector: los de la imagen o
+	// los que informa el dispositivo de bloque
+	struct stat st;
+	if (fstat(disk->fd, &st) == 0) {
+		if (S_ISREG(st.st_mode)) {
+			disk->size_bytes = (unsigned long long)st.st_size;
+			int container = image_open(disk);
+			if (container < 0) {
+				close(disk->fd);
+				disk->fd = -1;
+				return 0;
+			}
+			// Una imagen cruda leída con O_DIRECT no se proyecta: la proyección pasa por la caché de páginas
+			if (container == 0) {
+				disk->sparse = 1;
+				if (!(flags & DISK_OPEN_DIRECT) || !disk_direct(disk, (unsigned int)st.st_blksize)) {
+					disk_map_image(disk);
+				}
+			}
+			disk->sector_size = disk->image != NULL && disk->image->sector_size != 0
+				? disk->image->sector_size : probe_image_sector_size(disk);
+			disk->physical_sector_size = disk->sector_size;
+		}
+#ifdef __linux__
+		else if (S_ISBLK(st.st_mode)) {
+			unsigned long long size = 0;
+			int logical = 0;
+			unsigned int physical = 0;
+			if (ioctl(disk->fd, BLKGETSIZE64, &size) == 0) {
+				disk->size_bytes = size;
+			}
+			if (ioctl(disk->fd, BLKSSZGET, &logical) == 0 && valid_sector_size((unsigned int)logical)) {
+				disk->sector_size = (unsigned int)logical;
+				disk->physical_sector_size = disk->sector_size;
+			}
+			if (ioctl(disk->fd, BLKPBSZGET, &physical) == 0 && valid_sector_size(physical)
+					&& physical >= disk->sector_size) {
+				disk->physical_sector_size = physical;
+			}
+			if (flags & DISK_OPEN_DIRECT) {
+				disk_direct(disk, disk->sector_size);
+			}
+		}
+#endif
+	}
+
+	// Memoria de la caché: un bloque físico por entrada (las imágenes
+	// proyectadas en memoria no la usan), alineada para la lectura directa
+	if (disk->memory != NULL) {
+		return 1;
+	}
+	void *cache_data;
+	if (posix_memalign(&cache_data, disk->direct ? disk->direct_align : sizeof(void *),
+			(size_t)DISK_CACHE_SLOTS * disk->physical_sector_size) != 0) {
+		free(disk->direct_buf);
+		disk->direct_buf = NULL;
+		image_close(disk->image);
+		disk->image = NULL;
+		close(disk->fd);
+		disk->fd = -1;
+		return 0;
+	}
+	disk->cache_data = (char *)cache_data;
+	for (int i = 0; i < DISK_CACHE_SLOTS; i++) {
+		disk->cache[i].data = disk->cache_data + (size_t)i * disk->physical_sector_size;
+	}
+	return 1;
+}
+
+int disk_open_memory(disk_handle *disk, const void *data, unsigned long long size, unsigned int sector_size) {
+	memset(disk, 0, sizeof(disk_handle));
+	disk->fd = -1;
+	disk->path = "(memoria)";
+	disk->memory = (const char *)data;
+	disk->size_bytes = size;
+	if (sector_size == 0) {
+		sector_size = probe_image_sector_size(disk);
+	}
+	if (!valid_sector_size(sector_size)) {
+		disk->memory = NULL;
+		return 0;
+	}
+	disk->sector_size = sector_size;
+	disk->physical_sector_size = sector_size;
+	return 1;
+}
+
+/**
+ * @brief Puntero a sectores del disco en memoria, sin registrar la lectura.
+ */
+static const char *memory_range(disk_handle *disk, unsigned long long lba, unsigned long long count) {
+	unsigned long long offset = lba * disk->sector_size;
+	unsigned long long size = count * disk->sector_size;
+
+	if (disk->memory == NULL || offset > disk->size_bytes || size > disk->size_bytes - offset) {
+		return NULL;
+	}
+	return disk->memory + offset;
+}
+
+const void *disk_view(disk_handle *disk, unsigned long long lba, unsigned long long count) {
+	unsigned long long start = stats_begin();
+	const char *view = memory_range(disk, lba, count);
+
+	// Cuenta como una lectura de los sectores vistos, como si se copiaran
+	stats_end(STATS_READ, start, view != NULL ? count * disk->sector_size : 0);
+	return view;
+}
+
+void disk_prefetch(disk_handle *disk, unsigned long long lba, unsigned long long count) {
+	if (disk->memory != NULL) {
+#ifdef MADV_WILLNEED
+		// Pedir las páginas de la proyección que contienen los sectores
+		const char *start = memory_range(disk, lba, count);
+		if (disk->mapped && start != NULL) {
+			uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+			uintptr_t first = (uintptr_t)start & ~(page - 1);
+			madvise((void *)first, (uintptr_t)start + count * disk->sector_size - first, MADV_WILLNEED);
+		}
+#endif
+		return;
+	}
+	// En las imágenes de máquinas virtuales los sectores no están en su posición
+	// del archivo, y la lectura directa no usa la caché de páginas que se llenaría
+	if (disk->image != NULL || disk->direct || in_window(disk, lba, count)) {
+		return;
+	}
+#ifdef POSIX_FADV_WILLNEED
+	posix_fadvise(disk->fd, (off_t)(lba * disk->sector_size), (off_t)(count * disk->sector_size),
+			POSIX_FADV_WILLNEED);
+#endif
+}
+
+unsigned long long disk_last_lba(disk_handle *disk) {
+	if (disk->size_bytes < disk->sector_size) {
+		return 0;
+	}
+	return disk->size_bytes / disk->sector_size - 1;
+}
+
+void disk_close(disk_handle *disk) {
+	if (disk->fd >= 0) {
+		close(disk->fd);
+	}
+	disk->fd = -1;
+	if (disk->mapped) {
+		munmap((void *)disk->memory, (size_t)disk->size_bytes);
+		disk->mapped = 0;
+	}
+	disk->memory = NULL;
+	image_close(disk->image);
+	disk->image = NULL;
+	free(disk->window);
+	disk->window = NULL;
+	disk->window_count = 0;
+	for (int i = 0; i < DISK_CACHE_SLOTS; i++) {
+		disk->cache[i].valid = 0;
+		disk->cache[i].data = NULL;
+	}
+	free(disk->cache_data);
+	disk->cache_data = NULL;
+	free(disk->direct_buf);
+	disk->direct_buf = NULL;
+	disk->direct = 0;
+}
+
+/**
+ * @brief Lee `size` bytes desde `offset`, repitiendo ante lecturas parciales.
+ * @return 1 si se leyeron todos los bytes, 0 en caso contrario.
+ */
+static int pread_full(int fd, char *buf, size_t size, unsigned long long offset) {
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = pread(fd, buf + done, size - done, (off_t)(offset + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			return 0;
+		}
+		done += (size_t)n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Activa la lectura directa (O_DIRECT) del descriptor.
+ *
+ * Reserva el buffer alineado por el que pasan las lecturas cuyo buffer,
+ * desplazamiento o longitud no son múltiplos de `align`. Si el sistema de
+ * archivos no admite O_DIRECT, el disco se sigue leyendo a través de la
+ * caché de páginas.
+ *
+ * @param align Tamaño de bloque lógico del dispositivo (o del sistema de archivos).
+ * @return 1 si la lectura directa quedó activa, 0 en caso contrario.
+ */
+static int disk_direct(disk_handle *disk, unsigned int align) {
+#ifdef O_DIRECT
+	void *buf;
+	int fl = fcntl(disk->fd, F_GETFL);
+
+	if (!valid_sector_size(align)) {
+		align = DISK_MAX_SECTOR_SIZE;
+	}
+	if (fl < 0 || posix_memalign(&buf, align, DISK_DIRECT_BUFFER) != 0) {
+		return 0;
+	}
+	if (fcntl(disk->fd, F_SETFL, fl | O_DIRECT) < 0) {
+		free(buf);
+		return 0;
+	}
+	disk->direct = 1;
+	disk->direct_align = align;
+	disk->direct_buf = (char *)buf;
+	return 1;
+#else
+	(void)disk;
+	(void)align;
+	return 0;
+#endif
+}
+
+/**
+ * @brief Lee con O_DIRECT hasta `len` bytes alineados desde `start`.
+ * @return 1 si se leyeron al menos `need` bytes, 0 ante un error, -1 si el
+ *         archivo rechazó la lectura directa (queda desactivada).
+ */
+static int direct_read(disk_handle *disk, char *dst, size_t len, unsigned long long start, size_t need) {
+	size_t done = 0;
+
+	while (done < need) {
+		ssize_t n = pread(disk->fd, dst + done, len - done, (off_t)(start + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+#ifdef O_DIRECT
+		// Algunos sistemas de archivos aceptan O_DIRECT al abrir pero no al leer
+		if (n < 0 && errno == EINVAL && done == 0) {
+			int fl = fcntl(disk->fd, F_GETFL);
+			if (fl >= 0) {
+				fcntl(disk->fd, F_SETFL, fl & ~O_DIRECT);
+			}
+			disk->direct = 0;
+			return -1;
+		}
+#endif
+		if (n <= 0) {
+			return 0;
+		}
+		done += (size_t)n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Lee `size` bytes desde `offset` con O_DIRECT.
+ *
+ * Si el buffer, el desplazamiento y la longitud están alineados se lee sin
+ * copiar; si no, por tramos a través del buffer alineado del manejador.
+ * @return 1 si se leyeron todos los bytes, 0 en caso contrario.
+ */
+static int direct_pread(disk_handle *disk, char *buf, size_t size, unsigned long long offset) {
+	size_t align = disk->direct_align;
+	int ok;
+
+	if ((uintptr_t)buf % align == 0 && offset % align == 0 && size % align == 0) {
+		ok = direct_read(disk, buf, size, offset, size);
+		return ok < 0 ? pread_full(disk->fd, buf, size, offset) : ok;
+	}
+	while (size > 0) {
+		unsigned long long start = offset - offset % align;
+		size_t skip = (size_t)(offset - start);
+		size_t n = size < DISK_DIRECT_BUFFER - skip ? size : DISK_DIRECT_BUFFER - skip;
+		size_t len = (skip + n + align - 1) / align * align;
+
+		ok = direct_read(disk, disk->direct_buf, len, start, skip + n);
+		if (ok <= 0) {
+			return ok < 0 ? pread_full(disk->fd, buf, size, offset) : 0;
+		}
+		memcpy(buf, disk->direct_buf + skip, n);
+		buf += n;
+		offset += n;
+		size -= n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Lee `size` bytes desde `offset` del dispositivo, del disco en memoria
+ *        o del disco virtual de una imagen.
+ * @return 1 si se leyeron todos los bytes, 0 en caso contrario.
+ */
+static int disk_pread(disk_handle *disk, char *buf, size_t size, unsigned long long offset) {
+	unsigned long long start = stats_begin();
+	int ok;
+
+	if (disk->memory != NULL) {
+		if (offset > disk->size_bytes || size > disk->size_bytes - offset) {
+			return 0;
+		}
+		memcpy(buf, disk->memory + offset, size);
+		ok = 1;
+	} else if (disk->image != NULL) {
+		ok = image_read(disk->image, buf, size, offset);
+	} else if (disk->direct) {
+		ok = direct_pread(disk, buf, size, offset);
+	} else {
+		ok = pread_full(disk->fd, buf, size, offset);
+	}
+	stats_end(STATS_READ, start, ok ? size : 0);
+	return ok;
+}
+
+int disk_next_data(disk_handle *disk, unsigned long long lba, unsigned long long *start, unsigned long long *end) {
+	unsigned long long limit = disk->size_bytes;
+	unsigned long long offset = lba * disk->sector_size;
+	unsigned long long data, hole;
+	int found;
+
+	if (limit == 0 || (!disk->sparse && disk->image == NULL)) {
+		return -1;
+	}
+	if (offset >= limit) {
+		return 0;
+	}
+	if (disk->image != NULL) {
+		found = image_next_data(disk->image, offset, limit, &data, &hole);
+		if (found <= 0) {
+			return found;
+		}
+	} else {
+#ifdef SEEK_DATA
+		off_t pos = lseek(disk->fd, (off_t)offset, SEEK_DATA);
+		if (pos < 0) {
+			// ENXIO: no hay datos después de `offset`
+			return errno == ENXIO ? 0 : -1;
+		}
+		data = (unsigned long long)pos;
+		pos = lseek(disk->fd, pos, SEEK_HOLE);
+		if (pos < 0) {
+			return -1;
+		}
+		hole = (unsigned long long)pos < limit ? (unsigned long long)pos : limit;
+#else
+		return -1;
+#endif
+	}
+	*start = data / disk->sector_size;
+	*end = (hole + disk->sector_size - 1) / disk->sector_size;
+	return 1;
+}
+
+int disk_allocated(disk_handle *disk, unsigned long long lba, unsigned long long count, unsigned long long *bytes) {
+	unsigned long long limit = lba + count;
+	unsigned long long start, end;
+	int found = disk_next_data(disk, lba, &start, &end);
+
+	*bytes = 0;
+	while (found > 0 && start < limit) {
+		lba = end < limit ? end : limit;
+		*bytes += (lba - start) * disk->sector_size;
+		if (lba >= limit) {
+			break;
+		}
+		found = disk_next_data(disk, lba, &start, &end);
+	}
+	return found >= 0;
+}
+
+/**
+ * @brief Indica si los sectores `lba` .. `lba + count - 1` están en la ventana.
+ */
+static int in_window(disk_handle *disk, unsigned long long lba, unsigned long long count) {
+	return disk->window != NULL && lba >= disk->window_lba
+		&& lba + count <= disk->window_lba + disk->window_count;
+}
+
+int read_lba_sector(disk_handle *disk, unsigned long long lba, char *buf) {
+	disk_cache_entry *victim = &disk->cache[0];
+	unsigned int per_block = disk->physical_sector_size / disk->sector_size;
+	unsigned long long block = lba / per_block; // Bloque físico que contiene el sector
+	size_t offset = (size_t)(lba % per_block) * disk->sector_size;
+
+	// Un disco en memoria no necesita caché
+	if (disk->memory != NULL) {
+		if (!disk_pread(disk, buf, disk->sector_size, lba * disk->sector_size)) {
+			fprintf(stderr, "Error: No se pudo leer el sector %llu del dispositivo %s\n", lba, disk->path);
+			return 0;
+		}
+		return 1;
+	}
+
+	disk->clock++;
+	// Buscar el bloque en la caché y, de paso, la entrada menos reciente
+	for (int i = 0; i < DISK_CACHE_SLOTS; i++) {
+		disk_cache_entry *entry = &disk->cache[i];
+		if (entry->valid && entry->block == block) {
+			entry->last_use = disk->clock;
+			memcpy(buf, entry->data + offset, disk->sector_size);
+			return 1;
+		}
+		if (!entry->valid || (victim->valid && entry->last_use < victim->last_use)) {
+			victim = entry;
+		}
+	}
+
+	// Tomar el bloque de la ventana leída por adelantado, si está allí
+	if (in_window(disk, block * per_block, per_block)) {
+		memcpy(victim->data, disk->window + (block * per_block - disk->window_lba) * disk->sector_size,
+				disk->physical_sector_size);
+	}
+	// Leer el bloque físico completo con una lectura posicionada alineada
+	else if (!disk_pread(disk, victim->data, disk->physical_sector_size, block * disk->physical_sector_size)) {
+		fprintf(stderr, "Error: No se pudo leer el sector %llu del dispositivo %s\n", lba, disk->path);
+		victim->valid = 0;
+		return 0;
+	}
+
+	victim->block = block;
+	victim->valid = 1;
+	victim->last_use = disk->clock;
+	memcpy(buf, victim->data + offset, disk->sector_size);
+	return 1;
+}
+
+int disk_read(disk_handle *disk, unsigned long long lba, unsigned long long count, void *buf) {
+	unsigned long long start = lba * disk->sector_size;
+	unsigned long long end = (lba + count) * disk->sector_size;
+	unsigned long long aligned_start = start - start % disk->physical_sector_size;
+	unsigned long long aligned_end = end + (disk->physical_sector_size - end % disk->physical_sector_size) % disk->physical_sector_size;
+
+	if (in_window(disk, lba, count)) {
+		memcpy(buf, disk->window + (lba - disk->window_lba) * disk->sector_size, count * disk->sector_size);
+		return 1;
+	}
+	// Extender la lectura a bloques físicos completos cuando no está alineada
+	if (aligned_start != start || aligned_end != end) {
+		char *block = (char *)malloc(aligned_end - aligned_start);
+		if (block != NULL) {
+			if (disk_pread(disk, block, aligned_end - aligned_start, aligned_start)) {
+				memcpy(buf, block + (start - aligned_start), end - start);
+				free(block);
+				return 1;
+			}
+			free(block);
+		}
+	}
+	if (!disk_pread(disk, buf, count * disk->sector_size, lba * disk->sector_size)) {
+		fprintf(stderr, "Error: No se pudieron leer los sectores %llu-%llu del dispositivo %s\n",
+				lba, lba + count - 1, disk->path);
+		return 0;
+	}
+	return 1;
+}
+
+int disk_read_ranges(disk_handle *disk, disk_range *ranges, int count) {
+	uring_read reqs[count > 0 ? count : 1];
+	int n = 0;
+	int ok = 1;
+
+	// Los rangos que ya están en memoria no necesitan ir al dispositivo
+	for (int i = 0; i < count; i++) {
+		if (in_window(disk, ranges[i].lba, ranges[i].count)) {
+			disk_read(disk, ranges[i].lba, ranges[i].count, ranges[i].buf);
+			continue;
+		}
+		reqs[n].fd = disk->fd;
+		reqs[n].offset = ranges[i].lba * disk->sector_size;
+		reqs[n].len = ranges[i].count * disk->sector_size;
+		reqs[n].buf = ranges[i].buf;
+		n++;
+	}
+
+	// Un solo lote para todos los rangos; los incompletos se leen por la vía síncrona
+	if (n > 1 && disk->memory == NULL && disk->image == NULL) {
+		unsigned long long start = stats_begin();
+		unsigned long long bytes = 0;
+		uring_read_batch(reqs, n);
+		for (int r = 0; r < n; r++) {
+			bytes += reqs[r].done ? reqs[r].len : 0;
+		}
+		stats_end(STATS_READ, start, bytes);
+	} else {
+		for (int r = 0; r < n; r++) {
+			reqs[r].done = 0;
+		}
+	}
+	for (int r = 0; r < n; r++) {
+		if (!reqs[r].done && !disk_pread(disk, reqs[r].buf, reqs[r].len, reqs[r].offset)) {
+			fprintf(stderr, "Error: No se pudieron leer los sectores %llu-%llu del dispositivo %s\n",
+					reqs[r].offset / disk->sector_size,
+					(reqs[r].offset + reqs[r].len) / disk->sector_size - 1, disk->path);
+			ok = 0;
+		}
+	}
+	return ok;
+}
+
+int disk_prefetch_batch(disk_handle *disks, int count, unsigned long long lba, unsigned long long sectors) {
+	uring_read *reqs = (uring_read *)calloc(count, sizeof(uring_read));
+	int *owner = (int *)calloc(count, sizeof(int));
+	int n = 0;
+	int used = 0;
+
+	if (reqs == NULL || owner == NULL) {
+		free(reqs);
+		free(owner);
+		return 0;
+	}
+	// Preparar una lectura por disco abierto, redondeada a bloques físicos
+	for (int i = 0; i < count; i++) {
+		disk_handle *disk = &disks[i];
+		unsigned long long per_block = disk->physical_sector_size / disk->sector_size;
+		unsigned long long first = lba - lba % per_block;
+		unsigned long long total = (lba + sectors - first + per_block - 1) / per_block * per_block;
+		size_t len = total * disk->sector_size;
+		if (disk->fd < 0 || disk->memory != NULL || disk->image != NULL || disk->window != NULL) {
+			continue;
+		}
+		// Alineado para que la lectura también sea válida con O_DIRECT
+		if (posix_memalign(&reqs[n].buf, DISK_MAX_SECTOR_SIZE, len) != 0) {
+			continue;
+		}
+		reqs[n].fd = disk->fd;
+		reqs[n].offset = first * disk->sector_size;
+		reqs[n].len = len;
+		owner[n] = i;
+		n++;
+	}
+
+	// Enviar todas las lecturas juntas; las que no se completen se descartan
+	unsigned long long start = stats_begin();
+	unsigned long long bytes = 0;
+	used = uring_read_batch(reqs, n);
+	for (int r = 0; r < n; r++) {
+		disk_handle *disk = &disks[owner[r]];
+		if (reqs[r].done) {
+			bytes += reqs[r].len;
+			disk->window = (char *)reqs[r].buf;
+			disk->window_lba = reqs[r].offset / disk->sector_size;
+			disk->window_count = reqs[r].len / disk->sector_size;
+		} else {
+			free(reqs[r].buf);
+		}
+	}
+	stats_end(STATS_READ, start, bytes);
+	free(reqs);
+	free(owner);
+	return used;
+}
@@ -0,0 +1,371 @@
+/**
+ * @file disk.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Manejador reutilizable de dispositivos de bloque e imágenes de disco.
+ *
+ * El dispositivo se abre una sola vez con `open()` y los sectores se leen con
+ * lecturas posicionadas (`pread()`). Los sectores leídos recientemente se
+ * conservan en una pequeña caché LRU, de forma que analizar un disco completo
+ * cuesta una apertura y unas pocas lecturas. Para analizar muchos dispositivos
+ * a la vez, sus primeros sectores pueden leerse por adelantado en un solo
+ * lote asíncrono (ver disk_prefetch_batch()). Las imágenes de máquinas
+ * virtuales (qcow2, VHD, VHDX, VMDK) se leen a través de sus tablas de
+ * traducción y las comprimidas con gzip, xz o zstd se descomprimen en flujo
+ * (ver image.h y compress.h).
+ * @copyright MIT License
+ */
+#ifndef DISK_H
+#define DISK_H
+
+/**
+ * @def SECTOR_SIZE
+ * @brief Tamaño estándar de un sector de disco (512 bytes).
+ *
+ * Es el tamaño que se asume cuando no se puede detectar otro.
+ */
+#define SECTOR_SIZE 512
+
+/**
+ * @def DISK_MAX_SECTOR_SIZE
+ * @brief Tamaño máximo de sector soportado (discos 4Kn).
+ *
+ * Los buffers de un sector que se pasan a read_lba_sector() deben tener al
+ * menos este tamaño, o `sector_size` bytes del manejador.
+ */
+#define DISK_MAX_SECTOR_SIZE 4096
+
+/**
+ * @def DISK_CACHE_SLOTS
+ * @brief Cantidad de bloques físicos que conserva la caché LRU de cada manejador.
+ */
+#define DISK_CACHE_SLOTS 8
+
+/**
+ * @def DISK_PROBE_SECTORS
+ * @brief Sectores que se leen por adelantado al analizar un lote de discos.
+ *
+ * Cubre el MBR (LBA 0), la cabecera GPT (LBA 1) y el arreglo estándar de
+ * 128 descriptores de 128 bytes (LBA 2 a 33).
+ */
+#define DISK_PROBE_SECTORS 34
+
+/**
+ * @def DISK_DIRECT_BUFFER
+ * @brief Tamaño del buffer alineado por el que pasan las lecturas directas
+ *        no alineadas (ver DISK_OPEN_DIRECT).
+ */
+#define DISK_DIRECT_BUFFER (64 * 1024)
+
+/**
+ * @def DISK_OPEN_DIRECT
+ * @brief Opción de disk_open_flags(): leer el disco crudo con O_DIRECT.
+ */
+#define DISK_OPEN_DIRECT 0x1
+
+/**
+ * @struct disk_cache_entry
+ * @brief Entrada de la caché de sectores.
+ *
+ * Cada entrada guarda un bloque físico completo, que puede contener varios
+ * sectores lógicos (discos 512e).
+ *
+ * @var disk_cache_entry::block
+ * Bloque físico almacenado en la entrada.
+ * @var disk_cache_entry::last_use
+ * Marca del último acceso, usada para desalojar la entrada menos reciente.
+ * @var disk_cache_entry::valid
+ * 1 si la entrada contiene datos leídos del disco.
+ * @var disk_cache_entry::data
+ * Contenido del bloque (`physical_sector_size` bytes).
+ */
+typedef struct {
+	unsigned long long block;
+	unsigned long last_use;
+	int valid;
+	char *data;
+} disk_cache_entry;
+
+struct disk_image;
+
+/**
+ * @struct disk_handle
+ * @brief Dispositivo o imagen abierta para lectura.
+ *
+ * @var disk_handle::fd
+ * Descriptor de archivo del dispositivo.
+ * @var disk_handle::path
+ * Ruta del dispositivo, usada en los mensajes de error.
+ * @var disk_handle::memory
+ * Contenido del disco cuando está en memoria (imagen proyectada con mmap o
+ * disco abierto con disk_open_memory()), o NULL.
+ * @var disk_handle::mapped
+ * 1 si `memory` es una proyección que disk_close() debe liberar.
+ * @var disk_handle::image
+ * Imagen de máquina virtual que traduce las lecturas, o NULL si el archivo
+ * se lee como disco crudo.
+ * @var disk_handle::sparse
+ * 1 si el disco es un archivo regular crudo, cuyos huecos se consultan con
+ * `SEEK_DATA`/`SEEK_HOLE` (ver disk_next_data()).
+ * @var disk_handle::direct
+ * 1 si el descriptor lee con O_DIRECT, sin pasar por la caché de páginas.
+ * @var disk_handle::direct_align
+ * Alineación que exige la lectura directa (bloque lógico del dispositivo).
+ * @var disk_handle::direct_buf
+ * Buffer alineado de DISK_DIRECT_BUFFER bytes para las lecturas directas
+ * no alineadas, o NULL.
+ * @var disk_handle::sector_size
+ * Tamaño del sector lógico en bytes: la unidad de todas las direcciones LBA.
+ * @var disk_handle::physical_sector_size
+ * Tamaño del sector físico en bytes; las lecturas se alinean a este tamaño.
+ * @var disk_handle::size_bytes
+ * Tamaño total del dispositivo en bytes (0 si no se pudo determinar).
+ * @var disk_handle::clock
+ * Contador de accesos para la política LRU.
+ * @var disk_handle::cache
+ * Bloques leídos recientemente.
+ * @var disk_handle::cache_data
+ * Memoria de los bloques de la caché.
+ * @var disk_handle::window
+ * Sectores leídos por adelantado, o NULL si no hay ninguno.
+ * @var disk_handle::window_lba
+ * Primer sector contenido en `window`.
+ * @var disk_handle::window_count
+ * Cantidad de sectores contenidos en `window`.
+ */
+typedef struct {
+	int fd;
+	const char *path;
+	const char *memory;
+	int mapped;
+	struct disk_image *image;
+	int sparse;
+	int direct;
+	unsigned int direct_align;
+	char *direct_buf;
+	unsigned int sector_size;
+	unsigned int physical_sector_size;
+	unsigned long long size_bytes;
+	unsigned long clock;
+	disk_cache_entry cache[DISK_CACHE_SLOTS];
+	char *cache_data;
+	char *window;
+	unsigned long long window_lba;
+	unsigned long long window_count;
+} disk_handle;
+
+/**
+ * @struct disk_range
+ * @brief Rango de sectores que forma parte de una lectura múltiple.
+ *
+ * @var disk_range::lba
+ * Primer sector del rango.
+ * @var disk_range::count
+ * Cantidad de sectores.
+ * @var disk_range::buf
+ * Buffer con capacidad para `count * sector_size` bytes.
+ */
+typedef struct {
+	unsigned long long lba;
+	unsigned long long count;
+	void *buf;
+} disk_range;
+
+/**
+ * @brief Abre un dispositivo o imagen de disco para lectura.
+ *
+ * Detecta el tamaño de sector: en dispositivos de bloque con `BLKSSZGET`
+ * (lógico) y `BLKPBSZGET` (físico); en imágenes buscando la firma
+ * "EFI PART" de la cabecera GPT en los desplazamientos 512 y 4096. Si no se
+ * puede determinar, se asume SECTOR_SIZE.
+ *
+ * Las imágenes (archivos regulares) se proyectan en memoria con mmap: las
+ * lecturas se atienden desde la proyección y disk_view() permite ver las
+ * estructuras del disco sin copiarlas. Las imágenes qcow2, VHD, VHDX y VMDK
+ * y las comprimidas no se proyectan: se abren con image_open() y las
+ * direcciones se refieren al disco que contienen.
+ *
+ * @param disk Manejador a inicializar.
+ * @param path Ruta del dispositivo o archivo. Debe permanecer válida mientras
+ *             el manejador esté abierto.
+ * @return int 1 si el dispositivo se pudo abrir, 0 si ocurrió un error.
+ */
+int disk_open(disk_handle *disk, const char *path);
+
+/**
+ * @brief Abre un dispositivo o imagen de disco con opciones.
+ *
+ * Con DISK_OPEN_DIRECT los dispositivos de bloque y las imágenes crudas se
+ * leen con O_DIRECT, sin llenar la caché de páginas del sistema (útil al
+ * analizar muchos discos en un equipo en producción): las imágenes crudas
+ * no se proyectan en memoria, la caché de sectores se reserva alineada al
+ * bloque lógico y las lecturas no alineadas pasan por un buffer alineado
+ * del manejador. Si el archivo no admite O_DIRECT, al abrirlo o en la
+ * primera lectura, se lee normalmente. Las imágenes de máquinas virtuales y
+ * las comprimidas siempre se leen a través de la caché de páginas.
+ *
+ * @param disk Manejador a inicializar.
+ * @param path Ruta del dispositivo o archivo.
+ * @param flags 0 o DISK_OPEN_DIRECT.
+ * @return int 1 si el dispositivo se pudo abrir, 0 si ocurrió un error.
+ */
+int disk_open_flags(disk_handle *disk, const char *path, int flags);
+
+/**
+ * @brief Prepara un manejador para leer un disco que ya está en memoria.
+ *
+ * Las lecturas se atienden copiando desde `data`, sin descriptor de archivo
+ * ni caché. El manejador no reserva memoria.
+ *
+ * @param disk Manejador a inicializar.
+ * @param data Contenido del disco. Debe permanecer válido mientras se use el manejador.
+ * @param size Tamaño de `data` en bytes.
+ * @param sector_size Tamaño de sector lógico, o 0 para detectarlo como en las imágenes.
+ * @return int 1 si el manejador quedó listo, 0 si el tamaño de sector no es válido.
+ */
+int disk_open_memory(disk_handle *disk, const void *data, unsigned long long size, unsigned int sector_size);
+
+/**
+ * @brief Cierra el dispositivo y descarta la caché de sectores.
+ *
+ * @param disk Manejador abierto con disk_open().
+ */
+void disk_close(disk_handle *disk);
+
+/**
+ * @brief Lee un sector específico de un disco y lo almacena en un buffer.
+ *
+ * Si el sector se encuentra en la caché no se accede al dispositivo. En caso
+ * contrario se lee, con una lectura posicionada, el bloque físico completo
+ * que lo contiene y se guarda en la caché, desalojando el bloque usado hace
+ * más tiempo.
+ *
+ * @param disk Manejador del dispositivo donde se encuentra el disco.
+ * @param lba Número lógico de bloque (LBA) que identifica el sector a leer.
+ * @param buf Buffer de memoria donde se almacenará el contenido del sector
+ *            leído; debe tener capacidad para `sector_size` bytes.
+ *
+ * @return int 1 si la lectura fue exitosa, 0 si ocurrió un error.
+ */
+int read_lba_sector(disk_handle *disk, unsigned long long lba, char *buf);
+
+/**
+ * @brief Lee un rango contiguo de sectores con una sola lectura posicionada.
+ *
+ * Pensada para estructuras que ocupan muchos sectores seguidos, como el
+ * arreglo de descriptores GPT. Los sectores leídos no pasan por la caché. La
+ * lectura se extiende hasta los límites de los bloques físicos.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param lba Primer sector a leer.
+ * @param count Cantidad de sectores a leer.
+ * @param buf Buffer con capacidad para `count * sector_size` bytes.
+ * @return int 1 si la lectura fue exitosa, 0 si ocurrió un error.
+ */
+int disk_read(disk_handle *disk, unsigned long long lba, unsigned long long count, void *buf);
+
+/**
+ * @brief Lee varios rangos de sectores no contiguos en paralelo.
+ *
+ * Los rangos que no están en la ventana leída por adelantado se envían
+ * juntos en un solo lote de io_uring, de modo que la lectura cuesta
+ * aproximadamente un viaje de ida y vuelta al dispositivo. Sin io_uring, o
+ * ante lecturas incompletas, se usan lecturas posicionadas síncronas.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param ranges Rangos a leer.
+ * @param count Cantidad de rangos.
+ * @return int 1 si todos los rangos se leyeron, 0 si alguno falló.
+ */
+int disk_read_ranges(disk_handle *disk, disk_range *ranges, int count);
+
+/**
+ * @brief Retorna un puntero a sectores del disco sin copiarlos.
+ *
+ * Solo es posible cuando el disco está en memoria (imagen proyectada o
+ * disk_open_memory()). El contenido es de solo lectura y deja de ser válido
+ * al cerrar el manejador. Con --stats cuenta como una lectura de
+ * `count` sectores; su tiempo no incluye los fallos de página, que ocurren
+ * al recorrer los sectores.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param lba Primer sector.
+ * @param count Cantidad de sectores.
+ * @return Puntero al primer sector, o NULL si el disco no está en memoria o
+ *         el rango excede su tamaño.
+ */
+const void *disk_view(disk_handle *disk, unsigned long long lba, unsigned long long count);
+
+/**
+ * @brief Pide al sistema que traiga sectores a memoria sin esperar la lectura.
+ *
+ * Es solo una sugerencia (`posix_fadvise(POSIX_FADV_WILLNEED)`, o
+ * `madvise(MADV_WILLNEED)` en las imágenes proyectadas): permite que la
+ * lectura de un sector que se necesitará pronto avance mientras se procesa
+ * el actual.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param lba Primer sector.
+ * @param count Cantidad de sectores.
+ */
+void disk_prefetch(disk_handle *disk, unsigned long long lba, unsigned long long count);
+
+/**
+ * @brief Retorna el último sector direccionable del dispositivo.
+ *
+ * @param disk Manejador del dispositivo.
+ * @return Último LBA, o 0 si el tamaño del dispositivo es desconocido.
+ */
+unsigned long long disk_last_lba(disk_handle *disk);
+
+/**
+ * @brief Busca el siguiente tramo de sectores con datos.
+ *
+ * En los archivos dispersos los huecos se obtienen del sistema de archivos
+ * con `lseek(SEEK_DATA)` y `lseek(SEEK_HOLE)`; en las imágenes de máquinas
+ * virtuales, de los bloques sin asignar de sus tablas. Un hueco se lee como
+ * ceros, así que quien recorre el disco puede saltarlo sin leerlo.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param lba Sector desde el que se busca.
+ * @param start Primer sector del tramo con datos (puede contener ceros en
+ *              sus extremos si el hueco no está alineado a sectores).
+ * @param end Sector siguiente al último del tramo.
+ * @return int 1 si se encontró un tramo, 0 si desde `lba` hasta el final
+ *         del disco solo hay huecos, -1 si el dispositivo no informa sus
+ *         huecos (dispositivos de bloque, discos en memoria, imágenes
+ *         comprimidas): todo el disco debe tratarse como datos.
+ */
+int disk_next_data(disk_handle *disk, unsigned long long lba, unsigned long long *start, unsigned long long *end);
+
+/**
+ * @brief Cuenta los bytes con datos de un rango de sectores.
+ *
+ * @param disk Manejador del dispositivo.
+ * @param lba Primer sector del rango.
+ * @param count Cantidad de sectores.
+ * @param bytes Bytes del rango que no son huecos.
+ * @return int 1 si se pudo contar, 0 si el dispositivo no informa sus huecos.
+ */
+int disk_allocated(disk_handle *disk, unsigned long long lba, unsigned long long count, unsigned long long *bytes);
+
+/**
+ * @brief Lee por adelantado el mismo rango de sectores de varios discos.
+ *
+ * Las lecturas de todos los discos se envían en un solo lote mediante
+ * io_uring y se guardan en la ventana de cada manejador, desde donde las
+ * atienden luego read_lba_sector() y disk_read(). Si io_uring no está
+ * disponible, o la lectura de un disco falla, ese disco simplemente queda sin
+ * ventana y se lee por la vía síncrona.
+ *
+ * @param disks Arreglo de manejadores abiertos (se omiten los que tengan
+ *              `fd < 0`, las imágenes ya proyectadas en memoria y las de
+ *              máquinas virtuales).
+ * @param count Cantidad de manejadores.
+ * @param lba Primer sector a leer en cada disco.
+ * @param sectors Cantidad de sectores a leer en cada disco.
+ * @return int 1 si se usó io_uring, 0 si se dejó la lectura a la vía síncrona.
+ */
+int disk_prefetch_batch(disk_handle *disks, int count, unsigned long long lba, unsigned long long sectors);
+
+#endif
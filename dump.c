@@ -0,0 +1,170 @@
+/**
+ * @file dump.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "dump.h"
+
+static const char dump_digits[] = "0123456789abcdef";
+
+/** @brief `dump_hex[b]` contiene "xx " para el byte `b`, con un byte de relleno. */
+static char dump_hex[256][4];
+/** @brief `dump_ascii[b]` es el carácter que representa al byte `b`. */
+static char dump_ascii[256];
+static pthread_once_t dump_once = PTHREAD_ONCE_INIT;
+
+// Genera las tablas de conversión
+static void dump_init(void) {
+	for (int b = 0; b < 256; b++) {
+		dump_hex[b][0] = dump_digits[b >> 4];
+		dump_hex[b][1] = dump_digits[b & 0x0f];
+		dump_hex[b][2] = ' ';
+		dump_hex[b][3] = ' ';
+		dump_ascii[b] = (b >= 0x20 && b < 0x7F) ? (char)b : '.';
+	}
+}
+
+size_t dump_format_size(size_t size, int show_offset) {
+	size_t rows = (size + DUMP_BYTES_PER_ROW - 1) / DUMP_BYTES_PER_ROW;
+	return rows * (DUMP_ROW_LEN + (show_offset ? DUMP_OFFSET_WIDTH : 0));
+}
+
+size_t dump_format(char *dst, const void *buf, size_t size, unsigned long long offset, int show_offset) {
+	const unsigned char *src = (const unsigned char *)buf;
+	char *p = dst;
+
+	pthread_once(&dump_once, dump_init);
+	for (size_t pos = 0; pos < size; pos += DUMP_BYTES_PER_ROW) {
+		size_t n = size - pos < DUMP_BYTES_PER_ROW ? size - pos : DUMP_BYTES_PER_ROW;
+
+		if (show_offset) {
+			unsigned long long value = offset + pos;
+			for (int d = 15; d >= 0; d--) {
+				p[d] = dump_digits[value & 0x0f];
+				value >>= 4;
+			}
+			p[16] = ' ';
+			p[17] = ' ';
+			p += DUMP_OFFSET_WIDTH;
+		}
+
+		if (n == DUMP_BYTES_PER_ROW) {
+			// Fila completa: cada copia de 4 bytes escribe un relleno que la
+			// siguiente (o la columna ASCII) sobrescribe
+			for (int i = 0; i < DUMP_BYTES_PER_ROW; i++) {
+				memcpy(p + 3 * i, dump_hex[src[pos + i]], 4);
+			}
+		} else {
+			// Última fila incompleta: completar con espacios para alinear el ASCII
+			for (size_t i = 0; i < n; i++) {
+				memcpy(p + 3 * i, dump_hex[src[pos + i]], 3);
+			}
+			memset(p + 3 * n, ' ', 3 * (DUMP_BYTES_PER_ROW - n));
+		}
+		p += 3 * DUMP_BYTES_PER_ROW;
+		for (size_t i = 0; i < n; i++) {
+			p[i] = dump_ascii[src[pos + i]];
+		}
+		p += n;
+		*p++ = '\n';
+	}
+	return (size_t)(p - dst);
+}
+
+int dump_write(FILE *out, const char *buf, size_t len) {
+	int fd = fileno(out);
+
+	if (fd < 0) {
+		return fwrite(buf, 1, len, out) == len;
+	}
+	// Vaciar lo que stdio tenga pendiente para conservar el orden de la salida
+	if (fflush(out) != 0) {
+		return 0;
+	}
+	while (len > 0) {
+		ssize_t n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return 0;
+		}
+		buf += n;
+		len -= (size_t)n;
+	}
+	return 1;
+}
+
+int dump_buffer(FILE *out, const void *buf, size_t size, unsigned long long offset, int show_offset) {
+	char text[(DUMP_ROW_LEN + DUMP_OFFSET_WIDTH) * 64]; // Suficiente para 1 KiB sin reservar memoria
+	size_t needed = dump_format_size(size, show_offset);
+	char *dst = text;
+	int ok;
+
+	if (needed > sizeof(text) && (dst = (char *)malloc(needed)) == NULL) {
+		return 0;
+	}
+	ok = dump_write(out, dst, dump_format(dst, buf, size, offset, show_offset));
+	if (dst != text) {
+		free(dst);
+	}
+	return ok;
+}
+
+int dump_disk_range(FILE *out, disk_handle *disk, unsigned long long offset, unsigned long long length) {
+	unsigned long long end = offset + length;
+	size_t sector_size = disk->sector_size;
+	unsigned long long data_start = 0, data_end = 0;
+	int ok = 1;
+
+	if (disk->size_bytes > 0 && end > disk->size_bytes) {
+		end = disk->size_bytes;
+	}
+	if (offset >= end) {
+		return 1;
+	}
+
+	// Espacio para un bloque más el sector parcial de cada extremo
+	char *data = (char *)malloc(DUMP_CHUNK_SIZE + 2 * sector_size);
+	char *text = (char *)malloc(dump_format_size(DUMP_CHUNK_SIZE, 1));
+	if (data == NULL || text == NULL) {
+		free(data);
+		free(text);
+		return 0;
+	}
+
+	for (unsigned long long pos = offset; ok && pos < end; ) {
+		size_t n = end - pos < DUMP_CHUNK_SIZE ? (size_t)(end - pos) : DUMP_CHUNK_SIZE;
+		unsigned long long lba = pos / sector_size;
+		size_t skip = (size_t)(pos % sector_size);
+		unsigned long long sectors = (skip + n + sector_size - 1) / sector_size;
+
+		// Un bloque que cae completo en un hueco se imprime como ceros, sin leerlo
+		if (lba >= data_end) {
+			int found = disk_next_data(disk, lba, &data_start, &data_end);
+			if (found <= 0) {
+				data_start = found == 0 ? ULLONG_MAX : lba;
+				data_end = ULLONG_MAX;
+			}
+		}
+		if (data_start >= lba + sectors) {
+			memset(data, 0, sectors * sector_size);
+		} else if (!disk_read(disk, lba, sectors, data)) {
+			ok = 0;
+			break;
+		}
+		ok = dump_write(out, text, dump_format(text, data + skip, n, pos, 1));
+		pos += n;
+	}
+
+	free(data);
+	free(text);
+	return ok;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file dump.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Volcado hexadecimal y ASCII con salida en bloque.
+ *
+ * Las filas de 16 bytes se formatean con tablas de búsqueda en un buffer
+ * de memoria, que luego se escribe con una sola llamada en lugar de una
+ * llamada de stdio por byte.
+ * @copyright MIT License
+ */
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <stdio.h>
+#include "disk.h"
+
+/**
+ * @def DUMP_BYTES_PER_ROW
+ * @brief Bytes que se muestran en cada fila del volcado.
+ */
+#define DUMP_BYTES_PER_ROW 16
+
+/**
+ * @def DUMP_OFFSET_WIDTH
+ * @brief Caracteres de la columna de desplazamiento (16 dígitos y dos espacios).
+ */
+#define DUMP_OFFSET_WIDTH 18
+
+/**
+ * @def DUMP_ROW_LEN
+ * @brief Longitud máxima de una fila formateada, sin la columna de desplazamiento.
+ *
+ * Cada byte ocupa tres caracteres en hexadecimal ("xx ") y uno en ASCII,
+ * más el salto de línea.
+ */
+#define DUMP_ROW_LEN (DUMP_BYTES_PER_ROW * 4 + 1)
+
+/**
+ * @def DUMP_CHUNK_SIZE
+ * @brief Bytes del disco que se leen y formatean por cada escritura.
+ */
+#define DUMP_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * @brief Calcula el tamaño del texto que produce dump_format().
+ *
+ * @param size Cantidad de bytes a volcar.
+ * @param show_offset 1 si cada fila lleva la columna de desplazamiento.
+ * @return size_t Cantidad de caracteres necesarios.
+ */
+size_t dump_format_size(size_t size, int show_offset);
+
+/**
+ * @brief Formatea un buffer como volcado hexadecimal y ASCII.
+ *
+ * Cada fila muestra hasta 16 bytes en hexadecimal seguidos de su
+ * representación ASCII; la última fila se completa con espacios para que
+ * la columna ASCII quede alineada.
+ *
+ * @param dst Destino, de al menos dump_format_size(size, show_offset) bytes.
+ * @param buf Datos a volcar.
+ * @param size Cantidad de bytes.
+ * @param offset Desplazamiento del primer byte, para la columna de desplazamiento.
+ * @param show_offset 1 para anteponer el desplazamiento a cada fila.
+ * @return size_t Cantidad de caracteres escritos (no se agrega '\0').
+ */
+size_t dump_format(char *dst, const void *buf, size_t size, unsigned long long offset, int show_offset);
+
+/**
+ * @brief Escribe un bloque de texto en un flujo con una sola escritura.
+ *
+ * Si el flujo tiene descriptor de archivo, se vacía su buffer y el bloque
+ * se envía con write(); si no (por ejemplo, un flujo en memoria), se usa
+ * fwrite().
+ *
+ * @param out Flujo destino.
+ * @param buf Texto a escribir.
+ * @param len Longitud del texto.
+ * @return int 1 si se escribió completo, 0 en caso de error.
+ */
+int dump_write(FILE *out, const char *buf, size_t len);
+
+/**
+ * @brief Vuelca un buffer de memoria en un flujo.
+ *
+ * @param out Flujo destino.
+ * @param buf Datos a volcar.
+ * @param size Cantidad de bytes.
+ * @param offset Desplazamiento del primer byte.
+ * @param show_offset 1 para anteponer el desplazamiento a cada fila.
+ * @return int 1 si se escribió completo, 0 en caso de error.
+ */
+int dump_buffer(FILE *out, const void *buf, size_t size, unsigned long long offset, int show_offset);
+
+/**
+ * @brief Vuelca un rango arbitrario de bytes de un disco.
+ *
+ * El rango se lee en bloques de DUMP_CHUNK_SIZE alineados a sectores y
+ * cada bloque se formatea y se escribe con una sola escritura. Si el rango
+ * excede el tamaño conocido del disco, se recorta. Los bloques que caen
+ * completos en un hueco (ver disk_next_data()) se vuelcan como ceros sin
+ * leerlos.
+ *
+ * @param out Flujo destino.
+ * @param disk Dispositivo abierto.
+ * @param offset Desplazamiento en bytes del primer byte a volcar.
+ * @param length Cantidad de bytes a volcar.
+ * @return int 1 si el volcado terminó, 0 si ocurrió un error de lectura o escritura.
+ */
+int dump_disk_range(FILE *out, disk_handle *disk, unsigned long long offset, unsigned long long length);
+
+#endif
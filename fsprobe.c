@@ -0,0 +1,386 @@
+/**
+ * @file fsprobe.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsprobe.h"
+
+/** @brief Desplazamiento del superbloque de Btrfs dentro de la segunda región. */
+#define FSPROBE_BTRFS_SB ((64 * 1024) - FSPROBE_TAIL_OFFSET)
+
+static unsigned int le16(const unsigned char *p) {
+	return (unsigned int)p[0] | (unsigned int)p[1] << 8;
+}
+
+static unsigned int le32(const unsigned char *p) {
+	return le16(p) | (unsigned int)le16(p + 2) << 16;
+}
+
+static unsigned long long le64(const unsigned char *p) {
+	return (unsigned long long)le32(p) | (unsigned long long)le32(p + 4) << 32;
+}
+
+static unsigned int be32(const unsigned char *p) {
+	return (unsigned int)p[0] << 24 | (unsigned int)p[1] << 16 | (unsigned int)p[2] << 8 | (unsigned int)p[3];
+}
+
+static unsigned long long be64(const unsigned char *p) {
+	return (unsigned long long)be32(p) << 32 | be32(p + 4);
+}
+
+/**
+ * @brief Verifica que `buf` contenga `magic` en el desplazamiento `off`.
+ */
+static int has_magic(const unsigned char *buf, size_t len, size_t off, const char *magic, size_t n) {
+	return buf != NULL && off + n <= len && memcmp(buf + off, magic, n) == 0;
+}
+
+/**
+ * @brief Copia una etiqueta de longitud fija, sin el relleno de '\0' o espacios del final.
+ */
+static void copy_label(char *dst, const unsigned char *src, size_t n) {
+	size_t len = 0;
+
+	if (n > FSPROBE_LABEL_LEN - 1) {
+		n = FSPROBE_LABEL_LEN - 1;
+	}
+	while (len < n && src[len] != '\0') {
+		len++;
+	}
+	while (len > 0 && src[len - 1] == ' ') {
+		len--;
+	}
+	memcpy(dst, src, len);
+	dst[len] = '\0';
+}
+
+/**
+ * @brief Escribe 16 bytes como UUID en el orden en que están en el disco.
+ */
+static void format_uuid(char *dst, const unsigned char *p) {
+	snprintf(dst, FSPROBE_UUID_LEN,
+			"%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
+			p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7],
+			p[8], p[9], p[10], p[11], p[12], p[13], p[14], p[15]);
+}
+
+static int probe_luks(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)tail;
+	(void)tail_len;
+	if (!has_magic(head, head_len, 0, "LUKS\xba\xbe", 6) || head_len < 208) {
+		return 0;
+	}
+	info->type = "crypto_LUKS";
+	copy_label(info->uuid, head + 168, FSPROBE_UUID_LEN - 1);
+	// Solo LUKS2 tiene etiqueta en la cabecera binaria
+	if (head[6] == 0 && head[7] == 2) {
+		copy_label(info->label, head + 24, 48);
+	}
+	return 1;
+}
+
+static int probe_lvm(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)tail;
+	(void)tail_len;
+	// La etiqueta puede estar en cualquiera de los primeros cuatro sectores de 512 bytes
+	for (size_t off = 0; off < 4 * 512; off += 512) {
+		if (!has_magic(head, head_len, off, "LABELONE", 8) || !has_magic(head, head_len, off + 24, "LVM2 001", 8)) {
+			continue;
+		}
+		size_t pv = off + le32(head + off + 20);
+		if (pv + 32 > head_len) {
+			return 0;
+		}
+		const unsigned char *u = head + pv;
+		info->type = "LVM2_member";
+		snprintf(info->uuid, FSPROBE_UUID_LEN, "%.6s-%.4s-%.4s-%.4s-%.4s-%.4s-%.6s",
+				u, u + 6, u + 10, u + 14, u + 18, u + 22, u + 26);
+		return 1;
+	}
+	return 0;
+}
+
+static int probe_xfs(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)tail;
+	(void)tail_len;
+	if (!has_magic(head, head_len, 0, "XFSB", 4) || head_len < 120) {
+		return 0;
+	}
+	info->type = "xfs";
+	info->size_bytes = be64(head + 8) * be32(head + 4);
+	format_uuid(info->uuid, head + 32);
+	copy_label(info->label, head + 108, 12);
+	return 1;
+}
+
+static int probe_btrfs(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)head;
+	(void)head_len;
+	if (!has_magic(tail, tail_len, FSPROBE_BTRFS_SB + 0x40, "_BHRfS_M", 8)
+			|| FSPROBE_BTRFS_SB + 0x12b + 256 > tail_len) {
+		return 0;
+	}
+	info->type = "btrfs";
+	info->size_bytes = le64(tail + FSPROBE_BTRFS_SB + 0x70);
+	format_uuid(info->uuid, tail + FSPROBE_BTRFS_SB + 0x20);
+	copy_label(info->label, tail + FSPROBE_BTRFS_SB + 0x12b, 256);
+	return 1;
+}
+
+static int probe_ext(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	const unsigned char *sb = head + 1024;
+	(void)tail;
+	(void)tail_len;
+	if (head_len < 1024 + 0x88 || le16(sb + 0x38) != 0xEF53) {
+		return 0;
+	}
+	unsigned int compat = le32(sb + 0x5C);
+	unsigned int incompat = le32(sb + 0x60);
+	unsigned int ro_compat = le32(sb + 0x64);
+	if (incompat & 0x0008) {
+		return 0; // Dispositivo de journal externo, no un sistema de archivos
+	}
+	// ext4 usa características que ext3 no soporta; ext3 se distingue de ext2 por el journal
+	if ((incompat & ~0x0016U) != 0 || (ro_compat & ~0x0007U) != 0) {
+		info->type = "ext4";
+	} else if (compat & 0x0004) {
+		info->type = "ext3";
+	} else {
+		info->type = "ext2";
+	}
+	// Con la característica 64bit la cantidad de bloques tiene una parte alta
+	unsigned long long blocks = le32(sb + 0x04);
+	if (incompat & 0x0080) {
+		blocks |= (unsigned long long)le32(sb + 0x150) << 32;
+	}
+	if (le32(sb + 0x18) <= 6) {
+		info->size_bytes = blocks << (10 + le32(sb + 0x18));
+	}
+	format_uuid(info->uuid, sb + 0x68);
+	copy_label(info->label, sb + 0x78, 16);
+	return 1;
+}
+
+static int probe_swap(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	// La firma está al final de la primera página; se prueban páginas de 4, 8 y 64 KiB
+	unsigned long long page = 0;
+	if (has_magic(head, head_len, 4096 - 10, "SWAPSPACE2", 10)) {
+		page = 4096;
+	} else if (has_magic(head, head_len, 8192 - 10, "SWAPSPACE2", 10)) {
+		page = 8192;
+	} else if (has_magic(tail, tail_len, 64 * 1024 - FSPROBE_TAIL_OFFSET - 10, "SWAPSPACE2", 10)) {
+		page = 64 * 1024;
+	}
+	if (page == 0) {
+		if (!has_magic(head, head_len, 4096 - 10, "SWAP-SPACE", 10)) {
+			return 0;
+		}
+		info->type = "swap"; // Formato antiguo, sin UUID ni etiqueta
+		return 1;
+	}
+	info->type = "swap";
+	info->size_bytes = ((unsigned long long)le32(head + 1024 + 4) + 1) * page; // last_page
+	format_uuid(info->uuid, head + 1024 + 12);
+	copy_label(info->label, head + 1024 + 28, 16);
+	return 1;
+}
+
+static int probe_ntfs(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)tail;
+	(void)tail_len;
+	if (!has_magic(head, head_len, 3, "NTFS    ", 8) || head_len < 512) {
+		return 0;
+	}
+	// La etiqueta está en el archivo $Volume, fuera del sector de arranque
+	info->type = "ntfs";
+	// El volumen no cuenta la copia del sector de arranque, que ocupa el sector siguiente
+	info->size_bytes = (le64(head + 0x28) + 1) * le16(head + 0x0B);
+	snprintf(info->uuid, FSPROBE_UUID_LEN, "%016llX", le64(head + 0x48));
+	return 1;
+}
+
+static int probe_exfat(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	(void)tail;
+	(void)tail_len;
+	if (!has_magic(head, head_len, 3, "EXFAT   ", 8) || head_len < 512) {
+		return 0;
+	}
+	// La etiqueta está en el directorio raíz, fuera del sector de arranque
+	unsigned int serial = le32(head + 0x64);
+	info->type = "exfat";
+	if (head[0x6C] >= 9 && head[0x6C] <= 12) {
+		info->size_bytes = le64(head + 0x48) << head[0x6C];
+	}
+	snprintf(info->uuid, FSPROBE_UUID_LEN, "%04X-%04X", serial >> 16, serial & 0xFFFF);
+	return 1;
+}
+
+static int probe_fat(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	size_t ext; // Inicio del bloque de parámetros extendido
+	(void)tail;
+	(void)tail_len;
+	if (head_len < 512 || le16(head + 510) != 0xAA55 || (head[0] != 0xEB && head[0] != 0xE9)) {
+		return 0;
+	}
+	if (has_magic(head, head_len, 0x52, "FAT32   ", 8)) {
+		info->type = "fat32";
+		ext = 0x40;
+	} else if (has_magic(head, head_len, 0x36, "FAT12   ", 8)) {
+		info->type = "fat12";
+		ext = 0x24;
+	} else if (has_magic(head, head_len, 0x36, "FAT16   ", 8)) {
+		info->type = "fat16";
+		ext = 0x24;
+	} else if (has_magic(head, head_len, 0x36, "FAT     ", 8)) {
+		info->type = "fat";
+		ext = 0x24;
+	} else {
+		return 0;
+	}
+	unsigned long long sectors = le16(head + 0x13) != 0 ? le16(head + 0x13) : le32(head + 0x20);
+	info->size_bytes = sectors * le16(head + 0x0B);
+	// Número de serie y etiqueta solo si está la firma extendida 0x29
+	if (head[ext + 2] == 0x29) {
+		unsigned int serial = le32(head + ext + 3);
+		snprintf(info->uuid, FSPROBE_UUID_LEN, "%04X-%04X", serial >> 16, serial & 0xFFFF);
+		if (memcmp(head + ext + 7, "NO NAME    ", 11) != 0) {
+			copy_label(info->label, head + ext + 7, 11);
+		}
+	}
+	return 1;
+}
+
+/** @brief Detectores en el orden en que se prueban; los de firma más específica van primero. */
+static int (*const fsprobe_detectors[])(const unsigned char *, size_t, const unsigned char *, size_t,
+		fsprobe_info *) = {
+	probe_luks, probe_lvm, probe_xfs, probe_btrfs, probe_ext, probe_swap, probe_ntfs, probe_exfat, probe_fat
+};
+
+int fsprobe_identify(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info) {
+	memset(info, 0, sizeof(fsprobe_info));
+	if (tail == NULL) {
+		tail_len = 0;
+	}
+	for (size_t i = 0; i < sizeof(fsprobe_detectors) / sizeof(fsprobe_detectors[0]); i++) {
+		if (fsprobe_detectors[i](head, head_len, tail, tail_len, info)) {
+			return 1;
+		}
+		memset(info, 0, sizeof(fsprobe_info));
+	}
+	return 0;
+}
+
+static int compare_requests(const void *a, const void *b) {
+	const fsprobe_request *x = *(const fsprobe_request *const *)a;
+	const fsprobe_request *y = *(const fsprobe_request *const *)b;
+	return (x->start_lba > y->start_lba) - (x->start_lba < y->start_lba);
+}
+
+/**
+ * @brief Prepara la lectura de una región de una partición.
+ *
+ * Si el disco está en memoria retorna la región en su lugar; si no, agrega
+ * un rango al lote que se leerá en `buf`.
+ *
+ * @return Puntero donde estará la región, o NULL si queda fuera del disco.
+ */
+static const unsigned char *plan_region(disk_handle *disk, unsigned long long lba, unsigned long long sectors,
+		unsigned char *buf, disk_range *ranges, int *count) {
+	const void *view;
+
+	if (sectors == 0 || (disk->size_bytes > 0 && (lba + sectors) * disk->sector_size > disk->size_bytes)) {
+		return NULL;
+	}
+	if ((view = disk_view(disk, lba, sectors)) != NULL) {
+		return (const unsigned char *)view;
+	}
+	ranges[*count].lba = lba;
+	ranges[*count].count = sectors;
+	ranges[*count].buf = buf;
+	(*count)++;
+	return buf;
+}
+
+int fsprobe_partitions(disk_handle *disk, const fsprobe_request *reqs, int count) {
+	unsigned int sector_size = disk->sector_size;
+	unsigned long long head_max = FSPROBE_HEAD_SIZE / sector_size;
+	unsigned long long tail_lba = FSPROBE_TAIL_OFFSET / sector_size;
+	unsigned long long tail_sectors = FSPROBE_TAIL_SIZE / sector_size;
+	const fsprobe_request **order;
+	unsigned char *buf = NULL;
+	int ok = 1;
+
+	for (int i = 0; i < count; i++) {
+		memset(reqs[i].info, 0, sizeof(fsprobe_info));
+	}
+	if (count <= 0) {
+		return 1;
+	}
+	order = (const fsprobe_request **)malloc((size_t)count * sizeof(fsprobe_request *));
+	if (order == NULL) {
+		return 0;
+	}
+	// Un solo buffer para las regiones de un lote; en memoria no hace falta
+	if (disk->memory == NULL
+			&& (buf = (unsigned char *)malloc((size_t)FSPROBE_BATCH * (FSPROBE_HEAD_SIZE + FSPROBE_TAIL_SIZE))) == NULL) {
+		free(order);
+		return 0;
+	}
+
+	// Recorrer las particiones en orden de LBA para que las lecturas avancen sobre el disco
+	for (int i = 0; i < count; i++) {
+		order[i] = &reqs[i];
+	}
+	qsort(order, (size_t)count, sizeof(fsprobe_request *), compare_requests);
+
+	for (int first = 0; first < count; first += FSPROBE_BATCH) {
+		int n = count - first < FSPROBE_BATCH ? count - first : FSPROBE_BATCH;
+		disk_range ranges[2 * FSPROBE_BATCH];
+		const unsigned char *head[FSPROBE_BATCH];
+		const unsigned char *tail[FSPROBE_BATCH];
+		size_t head_len[FSPROBE_BATCH];
+		int nranges = 0;
+
+		for (int i = 0; i < n; i++) {
+			const fsprobe_request *req = order[first + i];
+			unsigned long long head_sectors = req->sectors < head_max ? req->sectors : head_max;
+			unsigned char *slot = buf != NULL ? buf + (size_t)i * (FSPROBE_HEAD_SIZE + FSPROBE_TAIL_SIZE) : NULL;
+
+			head_len[i] = (size_t)(head_sectors * sector_size);
+			head[i] = plan_region(disk, req->start_lba, head_sectors, slot, ranges, &nranges);
+			tail[i] = NULL;
+			// La segunda región solo se lee si la partición la contiene completa
+			if (head[i] != NULL && req->sectors >= tail_lba + tail_sectors) {
+				tail[i] = plan_region(disk, req->start_lba + tail_lba, tail_sectors,
+						slot != NULL ? slot + FSPROBE_HEAD_SIZE : NULL, ranges, &nranges);
+			}
+		}
+		if (nranges > 0 && !disk_read_ranges(disk, ranges, nranges)) {
+			ok = 0;
+			continue;
+		}
+		for (int i = 0; i < n; i++) {
+			if (head[i] != NULL) {
+				fsprobe_identify(head[i], head_len[i], tail[i], FSPROBE_TAIL_SIZE, order[first + i]->info);
+			}
+		}
+	}
+
+	free(buf);
+	free(order);
+	return ok;
+}
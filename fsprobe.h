@@ -0,0 +1,123 @@
+/**
+ * @file fsprobe.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Identificación del sistema de archivos de cada partición.
+ *
+ * Reconoce ext2/3/4, XFS, Btrfs, NTFS, FAT12/16/32, exFAT, swap, LUKS y
+ * volúmenes físicos LVM por las firmas de su superbloque, y obtiene la
+ * etiqueta y el UUID. De cada partición se leen solo dos regiones pequeñas:
+ * el comienzo (FSPROBE_HEAD_SIZE bytes) y la zona del superbloque de Btrfs
+ * y de la firma de swap con páginas de 64 KiB.
+ * @copyright MIT License
+ */
+#ifndef FSPROBE_H
+#define FSPROBE_H
+
+#include <stddef.h>
+#include "disk.h"
+
+/**
+ * @def FSPROBE_HEAD_SIZE
+ * @brief Bytes que se leen desde el inicio de la partición.
+ */
+#define FSPROBE_HEAD_SIZE 8192
+
+/**
+ * @def FSPROBE_TAIL_OFFSET
+ * @brief Desplazamiento de la segunda región, que contiene el superbloque
+ *        de Btrfs (64 KiB) y la firma de swap con páginas de 64 KiB.
+ */
+#define FSPROBE_TAIL_OFFSET (60 * 1024)
+
+/**
+ * @def FSPROBE_TAIL_SIZE
+ * @brief Bytes de la segunda región.
+ */
+#define FSPROBE_TAIL_SIZE 8192
+
+/**
+ * @def FSPROBE_BATCH
+ * @brief Particiones cuyas regiones se leen en un mismo lote.
+ */
+#define FSPROBE_BATCH 64
+
+/**
+ * @def FSPROBE_LABEL_LEN
+ * @brief Capacidad de la etiqueta, incluido el '\0' (la de Btrfs ocupa hasta 255 bytes).
+ */
+#define FSPROBE_LABEL_LEN 256
+
+/**
+ * @def FSPROBE_UUID_LEN
+ * @brief Capacidad del UUID en texto, incluido el '\0'.
+ */
+#define FSPROBE_UUID_LEN 40
+
+/**
+ * @struct fsprobe_info
+ * @brief Sistema de archivos encontrado en una partición.
+ *
+ * @var fsprobe_info::type
+ * Nombre corto ("ext4", "xfs", "btrfs", "ntfs", "fat32", "exfat", "swap",
+ * "crypto_LUKS", "LVM2_member", ...), o NULL si no se reconoció ninguno.
+ * @var fsprobe_info::label
+ * Etiqueta del volumen, o cadena vacía si no tiene o no está en el superbloque.
+ * @var fsprobe_info::uuid
+ * UUID o número de serie en el formato habitual del sistema de archivos.
+ * @var fsprobe_info::size_bytes
+ * Tamaño del volumen según su superbloque, o 0 si no lo indica (LUKS, LVM).
+ */
+typedef struct {
+	const char *type;
+	char label[FSPROBE_LABEL_LEN];
+	char uuid[FSPROBE_UUID_LEN];
+	unsigned long long size_bytes;
+} fsprobe_info;
+
+/**
+ * @struct fsprobe_request
+ * @brief Partición a examinar.
+ *
+ * @var fsprobe_request::start_lba
+ * Primer sector de la partición.
+ * @var fsprobe_request::sectors
+ * Cantidad de sectores; no se lee nada fuera de la partición.
+ * @var fsprobe_request::info
+ * Dónde se guarda el resultado.
+ */
+typedef struct {
+	unsigned long long start_lba;
+	unsigned long long sectors;
+	fsprobe_info *info;
+} fsprobe_request;
+
+/**
+ * @brief Identifica un sistema de archivos a partir de sus regiones ya leídas.
+ *
+ * @param head Comienzo de la partición.
+ * @param head_len Bytes válidos de `head` (hasta FSPROBE_HEAD_SIZE).
+ * @param tail Región que empieza en FSPROBE_TAIL_OFFSET, o NULL si la partición es más chica.
+ * @param tail_len Bytes válidos de `tail`.
+ * @param info Resultado.
+ * @return int 1 si se reconoció un sistema de archivos, 0 en caso contrario.
+ */
+int fsprobe_identify(const unsigned char *head, size_t head_len, const unsigned char *tail, size_t tail_len,
+		fsprobe_info *info);
+
+/**
+ * @brief Identifica el sistema de archivos de varias particiones.
+ *
+ * Las regiones se leen en orden de LBA, por lotes de FSPROBE_BATCH
+ * particiones, con disk_read_ranges(); si el disco está en memoria se
+ * examinan en su lugar, sin copiarlas.
+ *
+ * @param disk Dispositivo que contiene las particiones.
+ * @param reqs Particiones a examinar (el orden del arreglo no se modifica).
+ * @param count Cantidad de particiones.
+ * @return int 1 si todas las lecturas terminaron bien, 0 si alguna falló
+ *         (esas particiones quedan sin identificar).
+ */
+int fsprobe_partitions(disk_handle *disk, const fsprobe_request *reqs, int count);
+
+#endif
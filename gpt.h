@@ -1,185 +1,337 @@
-/**
- * @file gpt.h
- * @author Erwin Meza Vega <emezav@unicauca.edu.co>
- * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
- * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
- * @copyright MIT License
-*/
-
-#include "mbr.h"
-
-
-//Constante firma para todas las cabeceras de GPT 
-#define GPT_HEADER_SIGNATURE 0x5452415020494645
-/**
- * @struct guid
- * @brief Representación de un GUID (Globally Unique Identifier).
- * 
- * Un GUID es un identificador único utilizado en particiones GPT y otros contextos.
- * Para más detalles, consulte la especificación UEFI: 
- * https://uefi.org/specs/UEFI/2.10/Apx_A_GUID_and_Time_Formats.html
- * 
- * @var guid::time_lo
- * Campo bajo del timestamp.
- * @var guid::time_mid
- * Campo medio del timestamp.
- * @var guid::time_hi_and_version
- * Campo alto del timestamp y versión.
- * @var guid::clock_seq_hi_and_reserved
- * Campo alto de la secuencia de reloj.
- * @var guid::clock_seq_lo
- * Campo bajo de la secuencia de reloj.
- * @var guid::node
- * Identificador único espacial (6 bytes).
- */
-typedef struct {
-	unsigned int time_lo;                   ///< Campo bajo del timestamp.
-    unsigned short time_mid;                ///< Campo medio del timestamp.
-    unsigned short time_hi_and_version;     ///< Campo alto del timestamp y versión.
-    unsigned char clock_seq_hi_and_reserved;///< Campo alto de la secuencia de reloj.
-    unsigned char clock_seq_lo;             ///< Campo bajo de la secuencia de reloj.
-    unsigned char node[6];                  ///< Identificador único espacial.
-}__attribute__((packed))guid;
-
-
-/**
- * @struct gpt_header
- * @brief Encabezado de la tabla GPT.
- * 
- * Representa el encabezado de una tabla de particiones GPT. 
- * Contiene información sobre el esquema y la tabla de particiones.
-
- */
-typedef struct {
-	unsigned long long signature; 			 /*!< GPT signature */
-	unsigned int revision; 					 /*!< Revision */
-	unsigned int header_size; 				 /*!< Header size */
-	unsigned int header_crc32; 				 /*!< CRC32 of the header */
-	unsigned int reserved; 					 /*!< Reserved */
-	unsigned long long my_lba; 				 /*!< LBA of the header */
-	unsigned long long alternate_lba; 		 /*!< LBA of the alternate header */
-	unsigned long long first_usable_lba;	 /*!< First usable LBA for partitions */
-	unsigned long long last_usable_lba; 	 /*!< Last usable LBA for partitions */
-	guid disk_guid; 						 /*!< Disk GUID */
-	unsigned long long partition_entry_lba;  /*!< LBA of the partition table */
-	unsigned int num_partition_entries; 	 /*!< Number of partition entries */
-	unsigned int size_partition_entry; 		 /*!< Size of a partition entry */
-	unsigned int partition_entry_array_crc32;/*!< CRC32 of the partition entry array */
-	unsigned char content[420]; 			 /*!< Reserved */
-}__attribute__((packed)) gpt_header;
-
-
-
-
-/**
- * @struct gpt_partition_descriptor
- * @brief Descriptor de partición GPT.
- * 
- * Representa una entrada en la tabla de particiones GPT. 
- * Cada entrada describe una partición en el disco.
- */typedef struct {
-    guid partition_type_guid;   // GUID del tipo de partición
-    unsigned char unique_partition_guid[16];   // GUID único de la partición
-    unsigned long long starting_lba;   // LBA de inicio
-    unsigned long long ending_lba;     // LBA de fin
-    unsigned long long attributes;    // Atributos
-    unsigned char partition_name[72];  // Nombre de la partición
-    // Reservado 0 bytes
-} __attribute__((packed)) gpt_partition_descriptor;
-
-/**
- * @brief imprime la tabla de particiones del mbr de proteccion
- * @param boot_record mbr de proteccion encontrado
- */
-void print_gpt_protective_mbr_table(mbr *boot_record);
-
-/**
- * @brief imprime la tabla de particiones de gpt
- * @param partition variable que describe los elementos importantes del descriptor de particiones de gpt
- */
-void print_gpt_partition_table(gpt_partition_descriptor *partition);
-/**
- * @brief imprime la cabecera del gpt
- * @param hdr es la cabecera
- */
-void print_gpt_header(gpt_header * hdr);
-/**
- * @struct gpt_partition_type
- * @brief Tipo de partición GPT.
- * 
- * Contiene información descriptiva sobre un tipo de partición GPT.
- * 
- * @var gpt_partition_type::os
- * Sistema operativo asociado al tipo de partición.
- * @var gpt_partition_type::description
- * Descripción textual del tipo de partición.
- * @var gpt_partition_type::guid
- * GUID asociado al tipo de partición.
- */
-typedef struct {
-	const char *os;           ///< Sistema operativo asociado.
-    const char *description;  ///< Descripción del tipo de partición.
-    const char *guid;         ///< GUID del tipo de partición.
-} gpt_partition_type;
-
-
-/**
- * @brief Obtiene la descripción de un tipo de partición GPT.
- * 
- * Devuelve información descriptiva de un tipo de partición GPT basado en su GUID.
- * 
- * @param guid_str GUID de la partición en formato de cadena.
- * @return Puntero a una estructura `gpt_partition_type` con la descripción del tipo de partición.
- */
-const gpt_partition_type* get_gpt_partition_type(char * guid_str);
-
-/**
- * @brief Decodifica el nombre de una partición GPT.
- * 
- * Convierte un nombre de partición codificado en dos bytes por carácter 
- * en una cadena legible por humanos.
- * 
- * @param name Nombre de la partición codificado (72 bytes).
- * @return Puntero a una cadena con el nombre decodificado.
- */
-char *gpt_decode_partition_name(char name[72]);
-
-/**
- * @brief Verifica si un sector de arranque es un MBR protector.
- * 
- * Un MBR protector indica la presencia de una tabla de particiones GPT.
- * 
- * @param boot_record Sector de arranque leído en memoria.
- * @return 1 si el sector es un MBR protector, 0 en caso contrario.
- */
-int is_protective_mbr(mbr *boot_record);
-
-/**
- * @brief Verifica si un encabezado GPT es válido.
- * 
- * Comprueba la validez del encabezado de la tabla GPT según las especificaciones.
- * 
- * @param hdr Puntero al encabezado GPT.
- * @return 1 si el encabezado es válido, 0 en caso contrario.
- */
-int is_valid_gpt_header(gpt_header *hdr);
-
-/**
- * @brief Verifica si un descriptor de partición GPT está vacío.
- * 
- * Un descriptor se considera vacío si su GUID de tipo de partición es nulo.
- * 
- * @param desc Descriptor de partición.
- * @return 1 si el descriptor está vacío, 0 en caso contrario.
- */
-int is_null_descriptor(gpt_partition_descriptor *desc);
-
-/**
- * @brief Crea una representación legible de un GUID.
- * 
- * Convierte un GUID en su representación textual en formato estándar.
- * 
- * @param buf Buffer que contiene el GUID.
- * @return Puntero a una nueva cadena con la representación textual del GUID.
- */
-char *guid_to_str(guid *buf);
+/**
+ * @file gpt.h
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+*/
+#ifndef GPT_H
+#define GPT_H
+
+#include "mbr.h"
+#include "disk.h"
+
+
+//Constante firma para todas las cabeceras de GPT 
+#define GPT_HEADER_SIGNATURE 0x5452415020494645
+
+/**
+ * @def GPT_MAX_ENTRY_ARRAY_SIZE
+ * @brief Tamaño máximo (en bytes) aceptado para el arreglo de descriptores.
+ *
+ * Evita reservar memoria sin límite cuando la cabecera está corrupta.
+ */
+#define GPT_MAX_ENTRY_ARRAY_SIZE (16 * 1024 * 1024)
+
+/**
+ * @def GUID_STR_LEN
+ * @brief Tamaño del buffer para la representación textual de un GUID.
+ *
+ * 32 dígitos hexadecimales, cuatro guiones y el terminador.
+ */
+#define GUID_STR_LEN 37
+
+/**
+ * @def GPT_NAME_LEN
+ * @brief Tamaño del buffer para el nombre decodificado de una partición GPT.
+ *
+ * 36 unidades UTF-16 ocupan a lo sumo 3 bytes cada una en UTF-8, más el terminador.
+ */
+#define GPT_NAME_LEN (36 * 3 + 1)
+/**
+ * @struct guid
+ * @brief Representación de un GUID (Globally Unique Identifier).
+ * 
+ * Un GUID es un identificador único utilizado en particiones GPT y otros contextos.
+ * Para más detalles, consulte la especificación UEFI: 
+ * https://uefi.org/specs/UEFI/2.10/Apx_A_GUID_and_Time_Formats.html
+ * 
+ * @var guid::time_lo
+ * Campo bajo del timestamp.
+ * @var guid::time_mid
+ * Campo medio del timestamp.
+ * @var guid::time_hi_and_version
+ * Campo alto del timestamp y versión.
+ * @var guid::clock_seq_hi_and_reserved
+ * Campo alto de la secuencia de reloj.
+ * @var guid::clock_seq_lo
+ * Campo bajo de la secuencia de reloj.
+ * @var guid::node
+ * Identificador único espacial (6 bytes).
+ */
+typedef struct {
+	unsigned int time_lo;                   ///< Campo bajo del timestamp.
+    unsigned short time_mid;                ///< Campo medio del timestamp.
+    unsigned short time_hi_and_version;     ///< Campo alto del timestamp y versión.
+    unsigned char clock_seq_hi_and_reserved;///< Campo alto de la secuencia de reloj.
+    unsigned char clock_seq_lo;             ///< Campo bajo de la secuencia de reloj.
+    unsigned char node[6];                  ///< Identificador único espacial.
+}__attribute__((packed))guid;
+
+
+/**
+ * @struct gpt_header
+ * @brief Encabezado de la tabla GPT.
+ * 
+ * Representa el encabezado de una tabla de particiones GPT. 
+ * Contiene información sobre el esquema y la tabla de particiones.
+
+ */
+typedef struct {
+	unsigned long long signature; 			 /*!< GPT signature */
+	unsigned int revision; 					 /*!< Revision */
+	unsigned int header_size; 				 /*!< Header size */
+	unsigned int header_crc32; 				 /*!< CRC32 of the header */
+	unsigned int reserved; 					 /*!< Reserved */
+	unsigned long long my_lba; 				 /*!< LBA of the header */
+	unsigned long long alternate_lba; 		 /*!< LBA of the alternate header */
+	unsigned long long first_usable_lba;	 /*!< First usable LBA for partitions */
+	unsigned long long last_usable_lba; 	 /*!< Last usable LBA for partitions */
+	guid disk_guid; 						 /*!< Disk GUID */
+	unsigned long long partition_entry_lba;  /*!< LBA of the partition table */
+	unsigned int num_partition_entries; 	 /*!< Number of partition entries */
+	unsigned int size_partition_entry; 		 /*!< Size of a partition entry */
+	unsigned int partition_entry_array_crc32;/*!< CRC32 of the partition entry array */
+	unsigned char content[420]; 			 /*!< Reserved */
+}__attribute__((packed)) gpt_header;
+
+
+
+
+/**
+ * @struct gpt_partition_descriptor
+ * @brief Descriptor de partición GPT.
+ * 
+ * Representa una entrada en la tabla de particiones GPT. 
+ * Cada entrada describe una partición en el disco.
+ */typedef struct {
+    guid partition_type_guid;   // GUID del tipo de partición
+    unsigned char unique_partition_guid[16];   // GUID único de la partición
+    unsigned long long starting_lba;   // LBA de inicio
+    unsigned long long ending_lba;     // LBA de fin
+    unsigned long long attributes;    // Atributos
+    unsigned char partition_name[72];  // Nombre de la partición
+    // Reservado 0 bytes
+} __attribute__((packed)) gpt_partition_descriptor;
+
+/**
+ * @struct gpt_partition_type
+ * @brief Tipo de partición GPT.
+ * 
+ * Contiene información descriptiva sobre un tipo de partición GPT.
+ * 
+ * @var gpt_partition_type::os
+ * Sistema operativo asociado al tipo de partición.
+ * @var gpt_partition_type::description
+ * Descripción textual del tipo de partición.
+ * @var gpt_partition_type::guid
+ * GUID asociado al tipo de partición.
+ */
+typedef struct {
+	const char *os;           ///< Sistema operativo asociado.
+    const char *description;  ///< Descripción del tipo de partición.
+    const char *guid;         ///< GUID del tipo de partición.
+} gpt_partition_type;
+
+
+/**
+ * @brief Obtiene la descripción de un tipo de partición GPT.
+ * 
+ * Devuelve información descriptiva de un tipo de partición GPT basado en su GUID.
+ * 
+ * @param guid_str GUID de la partición en formato de cadena (mayúsculas o minúsculas).
+ * @return Puntero a una estructura `gpt_partition_type` con la descripción del tipo de partición.
+ */
+const gpt_partition_type* get_gpt_partition_type(char * guid_str);
+
+/**
+ * @brief Obtiene la descripción de un tipo de partición GPT a partir del GUID binario.
+ * 
+ * La tabla de tipos se convierte una sola vez, en el primer uso, en un índice
+ * ordenado de GUID binarios de 16 bytes, de modo que cada consulta es una
+ * búsqueda binaria que compara estructuras `guid` directamente, sin formatear
+ * el GUID como cadena.
+ * 
+ * @param type_guid GUID del tipo de partición, tal como aparece en el descriptor.
+ * @return Puntero al tipo de partición, o a un tipo "Unknown" si el GUID no
+ *         está en la tabla.
+ */
+const gpt_partition_type* gpt_partition_type_by_guid(const guid *type_guid);
+
+/**
+ * @brief Convierte la representación textual de un GUID a su forma binaria.
+ * 
+ * @param str GUID con formato `XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX`.
+ * @param out GUID resultante, con la misma disposición que en el disco.
+ * @return 1 si la cadena es un GUID válido, 0 en caso contrario.
+ */
+int str_to_guid(const char *str, guid *out);
+
+/**
+ * @brief Decodifica el nombre de una partición GPT.
+ * 
+ * Convierte un nombre de partición codificado en UTF-16LE (dos bytes por
+ * carácter) en una cadena UTF-8 legible por humanos. No reserva memoria: el
+ * resultado se escribe en el buffer del llamador.
+ * 
+ * @param name Nombre de la partición codificado (72 bytes).
+ * @param str Buffer donde se escribe el nombre decodificado.
+ * @return `str`.
+ */
+char *gpt_decode_partition_name(const unsigned char name[72], char str[GPT_NAME_LEN]);
+
+/**
+ * @brief Verifica si un sector de arranque es un MBR protector.
+ * 
+ * Un MBR protector indica la presencia de una tabla de particiones GPT.
+ * 
+ * @param boot_record Sector de arranque leído en memoria.
+ * @return 1 si el sector es un MBR protector, 0 en caso contrario.
+ */
+int is_protective_mbr(mbr *boot_record);
+
+/**
+ * @brief Verifica si un encabezado GPT es válido.
+ * 
+ * Comprueba la validez del encabezado de la tabla GPT según las especificaciones:
+ * la firma "EFI PART" y el CRC32 del encabezado.
+ * 
+ * @param hdr Puntero al encabezado GPT.
+ * @return 1 si el encabezado es válido, 0 en caso contrario.
+ */
+int is_valid_gpt_header(gpt_header *hdr);
+
+/**
+ * @brief Verifica el CRC32 del encabezado GPT.
+ * 
+ * El CRC se calcula sobre los primeros `header_size` bytes del encabezado,
+ * con el campo `header_crc32` en cero.
+ * 
+ * @param hdr Puntero al encabezado GPT.
+ * @return 1 si `header_crc32` coincide, 0 si no coincide o `header_size` es inválido.
+ */
+int gpt_header_crc_valid(const gpt_header *hdr);
+
+/**
+ * @brief Verifica el CRC32 del arreglo de descriptores de partición.
+ * 
+ * @param hdr Encabezado GPT que describe el arreglo.
+ * @param entries Arreglo leído con gpt_read_partition_array().
+ * @return 1 si `partition_entry_array_crc32` coincide, 0 en caso contrario.
+ */
+int gpt_entry_array_crc_valid(const gpt_header *hdr, const unsigned char *entries);
+
+/**
+ * @brief Verifica si un descriptor de partición GPT está vacío.
+ * 
+ * Un descriptor se considera vacío si su GUID de tipo de partición es nulo.
+ * 
+ * @param desc Descriptor de partición.
+ * @return 1 si el descriptor está vacío, 0 en caso contrario.
+ */
+int is_null_descriptor(gpt_partition_descriptor *desc);
+
+/**
+ * @brief Crea una representación legible de un GUID.
+ * 
+ * Convierte un GUID en su representación textual en formato estándar, con
+ * dígitos hexadecimales en minúsculas. No reserva memoria: el resultado se
+ * escribe en el buffer del llamador.
+ * 
+ * @param buf Buffer que contiene el GUID.
+ * @param str Buffer donde se escribe la representación textual.
+ * @return `str`.
+ */
+char *guid_to_str(const guid *buf, char str[GUID_STR_LEN]);
+
+/**
+ * @brief Lee el arreglo completo de descriptores de partición GPT.
+ *
+ * El rango `partition_entry_lba` .. `num_partition_entries * size_partition_entry`
+ * indicado por la cabecera se obtiene con una sola lectura posicionada, de
+ * modo que los descriptores se recorren luego desde memoria. El descriptor
+ * `k` se encuentra en el desplazamiento `k * size_partition_entry`.
+ *
+ * @param disk Dispositivo que contiene la tabla.
+ * @param hdr Cabecera GPT ya validada.
+ * @return Buffer con el arreglo (liberar con `free`), o NULL si la cabecera
+ *         describe un arreglo inválido o la lectura falla.
+ */
+unsigned char *gpt_read_partition_array(disk_handle *disk, gpt_header *hdr);
+
+/**
+ * @def GPT_DEFAULT_ARRAY_SECTORS
+ * @brief Sectores del arreglo estándar de 128 descriptores de 128 bytes.
+ *
+ * Se usa para adivinar la posición del arreglo de respaldo cuando la
+ * cabecera primaria no es válida.
+ */
+#define GPT_DEFAULT_ARRAY_SECTORS 32
+
+/**
+ * @struct gpt_table
+ * @brief Cabecera GPT junto con su arreglo de descriptores.
+ *
+ * @var gpt_table::header
+ * Cabecera leída del disco.
+ * @var gpt_table::entries
+ * Arreglo de descriptores (liberar con gpt_free_table()), o NULL. En las
+ * imágenes proyectadas en memoria apunta directamente a la proyección.
+ * @var gpt_table::entries_mapped
+ * 1 si `entries` apunta a la proyección del disco y no debe liberarse.
+ * @var gpt_table::header_read
+ * 1 si la cabecera se pudo leer.
+ * @var gpt_table::header_valid
+ * 1 si la cabecera tiene firma y CRC32 válidos.
+ * @var gpt_table::entries_valid
+ * 1 si el arreglo coincide con el CRC32 de la cabecera.
+ */
+typedef struct {
+	gpt_header header;
+	unsigned char *entries;
+	int entries_mapped;
+	int header_read;
+	int header_valid;
+	int entries_valid;
+} gpt_table;
+
+/**
+ * @brief Lee la tabla GPT primaria y, si hace falta, la de respaldo.
+ *
+ * La cabecera de respaldo se lee cuando `check_backup` es distinto de 0 o
+ * cuando la primaria no es válida; en ese caso se ubica con `alternate_lba`,
+ * o en el último sector del disco si la primaria no es utilizable. El
+ * arreglo primario y la región de respaldo (arreglo y cabecera, que según la
+ * especificación están contiguos al final del disco) se piden en una sola
+ * lectura múltiple, de modo que la comprobación cuesta un viaje al
+ * dispositivo y no dos.
+ *
+ * @param disk Dispositivo que contiene la tabla.
+ * @param check_backup Si es distinto de 0, leer siempre la tabla de respaldo.
+ * @param primary Tabla primaria (LBA 1).
+ * @param backup Tabla de respaldo; queda con `header_read == 0` si no se leyó.
+ * @return int 1 si alguna de las dos cabeceras es válida, 0 en caso contrario.
+ */
+int gpt_load_tables(disk_handle *disk, int check_backup, gpt_table *primary, gpt_table *backup);
+
+/**
+ * @brief Libera el arreglo de descriptores de una tabla.
+ *
+ * @param table Tabla leída con gpt_load_tables().
+ */
+void gpt_free_table(gpt_table *table);
+
+/**
+ * @brief Compara la tabla primaria con la de respaldo e informa las diferencias.
+ *
+ * Se comparan los campos de la cabecera que deben coincidir (con
+ * `my_lba`/`alternate_lba` intercambiados) y cada descriptor de partición.
+ *
+ * @param out Flujo donde se imprime el informe, o NULL para solo contar las diferencias.
+ * @param primary Tabla primaria.
+ * @param backup Tabla de respaldo.
+ * @return int Cantidad de diferencias encontradas.
+ */
+int gpt_compare_tables(FILE *out, const gpt_table *primary, const gpt_table *backup);
+
+#endif
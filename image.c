@@ -0,0 +1,672 @@
+/**
+ * @file image.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "image.h"
+#include "compress.h"
+
+/** @brief Máscara del desplazamiento en las entradas L1 y L2 de qcow2. */
+#define QCOW2_OFFSET_MASK 0x00fffffffffffe00ULL
+/** @brief Bit de las entradas L2 de qcow2 que indica un clúster comprimido. */
+#define QCOW2_COMPRESSED (1ULL << 62)
+/** @brief Bit de las entradas L2 de qcow2 (versión 3) que indica un clúster de ceros. */
+#define QCOW2_ZERO 1ULL
+/** @brief Bits de incompatibilidad de qcow2 que no impiden leer: sucia y corrupta. */
+#define QCOW2_INCOMPAT_READABLE 0x3ULL
+
+/** @brief Bloque no asignado en la BAT de VHD. */
+#define VHD_UNALLOCATED 0xFFFFFFFFu
+
+/** @brief Estados de las entradas de la BAT de VHDX con datos en el archivo. */
+#define VHDX_FULLY_PRESENT 6
+#define VHDX_PARTIALLY_PRESENT 7
+
+/** @brief Banderas de la cabecera de una extensión VMDK dispersa. */
+#define VMDK_FLAG_ZERO_GRAIN (1u << 2)
+#define VMDK_FLAG_COMPRESSED (1u << 16)
+/** @brief Directorio de granos ubicado en la cabecera del final (streamOptimized). */
+#define VMDK_GD_AT_END 0xFFFFFFFFFFFFFFFFULL
+/** @brief Bytes del marcador que precede a cada grano comprimido (LBA y tamaño). */
+#define VMDK_MARKER_SIZE 12
+
+/** @brief GUID de la región de la BAT de VHDX (en el orden de bytes del archivo). */
+static const unsigned char vhdx_bat_guid[16] = {
+	0x66, 0x77, 0xC2, 0x2D, 0x23, 0xF6, 0x00, 0x42, 0x9D, 0x64, 0x11, 0x5E, 0x9B, 0xFD, 0x4A, 0x08 };
+/** @brief GUID de la región de metadatos de VHDX. */
+static const unsigned char vhdx_metadata_guid[16] = {
+	0x06, 0xA2, 0x7C, 0x8B, 0x90, 0x47, 0x9A, 0x4B, 0xB8, 0xFE, 0x57, 0x5F, 0x05, 0x0F, 0x88, 0x6E };
+/** @brief Metadato "File Parameters" de VHDX: tamaño de bloque y banderas. */
+static const unsigned char vhdx_file_parameters_guid[16] = {
+	0x37, 0x67, 0xA1, 0xCA, 0x36, 0xFA, 0x43, 0x4D, 0xB3, 0xB6, 0x33, 0xF0, 0xAA, 0x44, 0xE7, 0x6B };
+/** @brief Metadato "Virtual Disk Size" de VHDX. */
+static const unsigned char vhdx_disk_size_guid[16] = {
+	0x24, 0x42, 0xA5, 0x2F, 0x1B, 0xCD, 0x76, 0x48, 0xB2, 0x11, 0x5D, 0xBE, 0xD8, 0x3B, 0xF4, 0xB8 };
+/** @brief Metadato "Logical Sector Size" de VHDX. */
+static const unsigned char vhdx_sector_size_guid[16] = {
+	0x1D, 0xBF, 0x41, 0x81, 0x6F, 0xA9, 0x09, 0x47, 0xBA, 0x47, 0xF2, 0x33, 0xA8, 0xFA, 0xAB, 0x5F };
+
+static unsigned int be32(const unsigned char *p) {
+	return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | p[3];
+}
+
+static unsigned long long be64(const unsigned char *p) {
+	return ((unsigned long long)be32(p) << 32) | be32(p + 4);
+}
+
+static unsigned int le16(const unsigned char *p) {
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8);
+}
+
+static unsigned int le32(const unsigned char *p) {
+	return (unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static unsigned long long le64(const unsigned char *p) {
+	return (unsigned long long)le32(p) | ((unsigned long long)le32(p + 4) << 32);
+}
+
+/**
+ * @brief Lee `size` bytes desde `offset`; lo que queda después del fin del
+ *        archivo se completa con ceros.
+ * @return 1 si se leyó, 0 si ocurrió un error de lectura.
+ */
+static int image_pread(int fd, void *buf, size_t size, unsigned long long offset) {
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = pread(fd, (char *)buf + done, size - done, (off_t)(offset + done));
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n < 0) {
+			return 0;
+		}
+		if (n == 0) {
+			memset((char *)buf + done, 0, size - done);
+			break;
+		}
+		done += (size_t)n;
+	}
+	return 1;
+}
+
+/**
+ * @brief Lee `len` bytes de metadatos en `offset` a través de la caché.
+ *
+ * Los campos leídos no deben cruzar un límite de IMAGE_META_SIZE bytes; las
+ * entradas de las tablas de traducción están alineadas a su tamaño.
+ */
+static int meta_read(disk_image *img, unsigned long long offset, void *out, size_t len) {
+	unsigned long long base = offset - offset % IMAGE_META_SIZE;
+	image_meta_entry *victim = &img->meta[0];
+
+	img->clock++;
+	for (int i = 0; i < IMAGE_META_SLOTS; i++) {
+		image_meta_entry *entry = &img->meta[i];
+		if (entry->valid && entry->offset == base) {
+			entry->last_use = img->clock;
+			memcpy(out, entry->data + (offset - base), len);
+			return 1;
+		}
+		if (!entry->valid || (victim->valid && entry->last_use < victim->last_use)) {
+			victim = entry;
+		}
+	}
+	if (!image_pread(img->fd, victim->data, IMAGE_META_SIZE, base)) {
+		victim->valid = 0;
+		return 0;
+	}
+	victim->offset = base;
+	victim->valid = 1;
+	victim->last_use = img->clock;
+	memcpy(out, victim->data + (offset - base), len);
+	return 1;
+}
+
+/* ---------------------------------------------------------------- qcow2 */
+
+static int qcow2_map(disk_image *img, unsigned long long index, image_extent *ext) {
+	unsigned long long l1_index = index / img->entries_per_table;
+	unsigned char raw[8];
+	unsigned long long l2_table, entry;
+
+	ext->kind = IMAGE_ZERO;
+	if (l1_index >= img->table_entries) {
+		return 1;
+	}
+	if (!meta_read(img, img->table + l1_index * 8, raw, 8)) {
+		return 0;
+	}
+	l2_table = be64(raw) & QCOW2_OFFSET_MASK;
+	if (l2_table == 0) {
+		return 1;
+	}
+	if (!meta_read(img, l2_table + (index % img->entries_per_table) * 8, raw, 8)) {
+		return 0;
+	}
+	entry = be64(raw);
+	if (entry & QCOW2_COMPRESSED) {
+		// Desplazamiento y cantidad de sectores de 512 bytes comparten los 62 bits bajos
+		unsigned int shift = 62 - (img->cluster_bits - 8);
+		unsigned long long sectors = ((entry >> shift) & ((1ULL << (img->cluster_bits - 8)) - 1)) + 1;
+		ext->kind = IMAGE_COMPRESSED;
+		ext->offset = entry & ((1ULL << shift) - 1);
+		ext->length = sectors * 512 - (ext->offset & 511);
+		return 1;
+	}
+	if ((entry & QCOW2_ZERO) || (entry & QCOW2_OFFSET_MASK) == 0) {
+		return 1;
+	}
+	ext->kind = IMAGE_DATA;
+	ext->offset = entry & QCOW2_OFFSET_MASK;
+	return 1;
+}
+
+static int qcow2_open(disk_image *img, const char *path, const unsigned char *hdr) {
+	unsigned int version = be32(hdr + 4);
+
+	img->cluster_bits = be32(hdr + 20);
+	if ((version != 2 && version != 3) || img->cluster_bits < 9 || img->cluster_bits > 21) {
+		fprintf(stderr, "Error: La cabecera qcow2 de %s no es valida\n", path);
+		return -1;
+	}
+	if (be64(hdr + 8) != 0) {
+		fprintf(stderr, "Error: La imagen qcow2 %s depende de un archivo base y no se puede leer sola\n", path);
+		return -1;
+	}
+	if (be32(hdr + 32) != 0) {
+		fprintf(stderr, "Error: La imagen qcow2 %s esta cifrada\n", path);
+		return -1;
+	}
+	if (version == 3 && (be64(hdr + 72) & ~QCOW2_INCOMPAT_READABLE) != 0) {
+		// Archivo de datos externo, compresión distinta de zlib o entradas L2 extendidas
+		fprintf(stderr, "Error: La imagen qcow2 %s usa caracteristicas no soportadas\n", path);
+		return -1;
+	}
+	img->format = "qcow2";
+	img->size = be64(hdr + 24);
+	img->block_size = 1ULL << img->cluster_bits;
+	img->entries_per_table = img->block_size / 8;
+	img->table_entries = be32(hdr + 36);
+	img->table = be64(hdr + 40);
+	img->zlib_window = -12; // deflate sin cabecera zlib
+	img->map = qcow2_map;
+	return 1;
+}
+
+/* ------------------------------------------------------------------ VHD */
+
+static int vhd_fixed_map(disk_image *img, unsigned long long index, image_extent *ext) {
+	ext->kind = IMAGE_DATA;
+	ext->offset = index * img->block_size;
+	return 1;
+}
+
+static int vhd_dynamic_map(disk_image *img, unsigned long long index, image_extent *ext) {
+	unsigned char raw[4];
+	unsigned int sector;
+
+	ext->kind = IMAGE_ZERO;
+	if (index >= img->table_entries) {
+		return 1;
+	}
+	if (!meta_read(img, img->table + index * 4, raw, 4)) {
+		return 0;
+	}
+	sector = be32(raw);
+	if (sector != VHD_UNALLOCATED) {
+		ext->kind = IMAGE_DATA;
+		ext->offset = (unsigned long long)sector * 512 + img->data_skip;
+	}
+	return 1;
+}
+
+static int vhd_open(disk_image *img, const char *path, const unsigned char *footer) {
+	unsigned int type = be32(footer + 60);
+
+	img->format = "vhd";
+	img->size = be64(footer + 48);
+	if (type == 2) {
+		// Disco fijo: los datos ocupan el archivo y el pie va al final
+		if (img->size > img->file_size - 512) {
+			fprintf(stderr, "Error: La imagen VHD %s esta truncada\n", path);
+			return -1;
+		}
+		img->block_size = 2 * 1024 * 1024;
+		img->map = vhd_fixed_map;
+		return 1;
+	}
+	if (type == 4) {
+		fprintf(stderr, "Error: La imagen VHD %s es diferencial y no se puede leer sin su padre\n", path);
+		return -1;
+	}
+	if (type != 3) {
+		fprintf(stderr, "Error: Tipo de disco VHD desconocido (%u) en %s\n", type, path);
+		return -1;
+	}
+
+	unsigned char dyn[64];
+	if (!image_pread(img->fd, dyn, sizeof(dyn), be64(footer + 16)) || memcmp(dyn, "cxsparse", 8) != 0) {
+		fprintf(stderr, "Error: La cabecera dinamica de la imagen VHD %s no es valida\n", path);
+		return -1;
+	}
+	img->table = be64(dyn + 16);
+	img->table_entries = be32(dyn + 28);
+	img->block_size = be32(dyn + 32);
+	if (img->block_size < 512 || (img->block_size & (img->block_size - 1)) != 0) {
+		fprintf(stderr, "Error: Tamano de bloque VHD invalido en %s\n", path);
+		return -1;
+	}
+	// Cada bloque empieza con un mapa de un bit por sector, redondeado a 512 bytes
+	img->data_skip = (img->block_size / 512 / 8 + 511) / 512 * 512;
+	img->map = vhd_dynamic_map;
+	return 1;
+}
+
+/* ----------------------------------------------------------------- VHDX */
+
+static int vhdx_map(disk_image *img, unsigned long long index, image_extent *ext) {
+	// Tras cada `entries_per_table` bloques de datos la BAT intercala una entrada de mapa de sectores
+	unsigned long long slot = index + index / img->entries_per_table;
+	unsigned char raw[8];
+	unsigned long long entry;
+	unsigned int state;
+
+	ext->kind = IMAGE_ZERO;
+	if (slot >= img->table_entries) {
+		return 1;
+	}
+	if (!meta_read(img, img->table + slot * 8, raw, 8)) {
+		return 0;
+	}
+	entry = le64(raw);
+	state = (unsigned int)(entry & 7);
+	if ((state == VHDX_FULLY_PRESENT || state == VHDX_PARTIALLY_PRESENT) && (entry >> 20) != 0) {
+		ext->kind = IMAGE_DATA;
+		ext->offset = (entry >> 20) * 1024 * 1024;
+	}
+	return 1;
+}
+
+/**
+ * @brief Busca un metadato de VHDX y copia su valor.
+ * @return 1 si se encontró y se leyó, 0 en caso contrario.
+ */
+static int vhdx_metadata(disk_image *img, unsigned long long region, const unsigned char *table, unsigned int count,
+		const unsigned char *id, void *out, size_t len) {
+	for (unsigned int i = 0; i < count; i++) {
+		const unsigned char *entry = table + 32 + (size_t)i * 32;
+		if (memcmp(entry, id, 16) == 0 && le32(entry + 20) >= len) {
+			return image_pread(img->fd, out, len, region + le32(entry + 16));
+		}
+	}
+	return 0;
+}
+
+static int vhdx_open(disk_image *img, const char *path) {
+	unsigned char hdr[80], regions[64 * 1024], *meta = NULL;
+	unsigned long long best_seq = 0, bat = 0, metadata = 0;
+	int have_header = 0, log_pending = 0;
+	unsigned char params[8], size[8], sector[4];
+	unsigned int count;
+	int ok = -1;
+
+	// Dos copias de la cabecera: vale la de mayor número de secuencia
+	for (int i = 1; i <= 2; i++) {
+		if (image_pread(img->fd, hdr, sizeof(hdr), (unsigned long long)i * 64 * 1024)
+				&& memcmp(hdr, "head", 4) == 0 && (!have_header || le64(hdr + 8) > best_seq)) {
+			static const unsigned char zero[16];
+			best_seq = le64(hdr + 8);
+			log_pending = memcmp(hdr + 48, zero, 16) != 0;
+			have_header = 1;
+		}
+	}
+	if (!have_header) {
+		fprintf(stderr, "Error: La imagen VHDX %s no tiene una cabecera valida\n", path);
+		return -1;
+	}
+	if (log_pending) {
+		fprintf(stderr, "Advertencia: La imagen VHDX %s tiene un registro sin aplicar; los datos pueden estar desactualizados\n", path);
+	}
+
+	if (!image_pread(img->fd, regions, sizeof(regions), 192 * 1024) || memcmp(regions, "regi", 4) != 0) {
+		fprintf(stderr, "Error: La tabla de regiones de la imagen VHDX %s no es valida\n", path);
+		return -1;
+	}
+	count = le32(regions + 8);
+	for (unsigned int i = 0; i < count && i < 2047; i++) {
+		const unsigned char *entry = regions + 16 + (size_t)i * 32;
+		if (memcmp(entry, vhdx_bat_guid, 16) == 0) {
+			bat = le64(entry + 16);
+			img->table_entries = le32(entry + 24) / 8;
+		} else if (memcmp(entry, vhdx_metadata_guid, 16) == 0) {
+			metadata = le64(entry + 16);
+		}
+	}
+	if (bat == 0 || metadata == 0) {
+		fprintf(stderr, "Error: La imagen VHDX %s no tiene BAT o region de metadatos\n", path);
+		return -1;
+	}
+
+	meta = (unsigned char *)malloc(64 * 1024);
+	if (meta == NULL || !image_pread(img->fd, meta, 64 * 1024, metadata) || memcmp(meta, "metadata", 8) != 0) {
+		fprintf(stderr, "Error: La region de metadatos de la imagen VHDX %s no es valida\n", path);
+		goto out;
+	}
+	count = le16(meta + 10);
+	if (count > 2047
+			|| !vhdx_metadata(img, metadata, meta, count, vhdx_file_parameters_guid, params, sizeof(params))
+			|| !vhdx_metadata(img, metadata, meta, count, vhdx_disk_size_guid, size, sizeof(size))
+			|| !vhdx_metadata(img, metadata, meta, count, vhdx_sector_size_guid, sector, sizeof(sector))) {
+		fprintf(stderr, "Error: Faltan metadatos en la imagen VHDX %s\n", path);
+		goto out;
+	}
+	if (le32(params + 4) & 2) {
+		fprintf(stderr, "Error: La imagen VHDX %s es diferencial y no se puede leer sin su padre\n", path);
+		goto out;
+	}
+	img->block_size = le32(params);
+	img->sector_size = le32(sector);
+	if (img->block_size < 1024 * 1024 || (img->block_size & (img->block_size - 1)) != 0
+			|| (img->sector_size != 512 && img->sector_size != 4096)) {
+		fprintf(stderr, "Error: Parametros de bloque VHDX invalidos en %s\n", path);
+		goto out;
+	}
+	img->format = "vhdx";
+	img->size = le64(size);
+	img->table = bat;
+	img->entries_per_table = (8388608ULL * img->sector_size) / img->block_size; // "chunk ratio"
+	img->map = vhdx_map;
+	ok = 1;
+out:
+	free(meta);
+	return ok;
+}
+
+/* ----------------------------------------------------------------- VMDK */
+
+static int vmdk_map(disk_image *img, unsigned long long index, image_extent *ext) {
+	unsigned long long gd_index = index / img->entries_per_table;
+	unsigned char raw[VMDK_MARKER_SIZE];
+	unsigned int table, grain;
+
+	ext->kind = IMAGE_ZERO;
+	if (gd_index >= img->table_entries) {
+		return 1;
+	}
+	if (!meta_read(img, img->table + gd_index * 4, raw, 4)) {
+		return 0;
+	}
+	table = le32(raw);
+	if (table == 0) {
+		return 1;
+	}
+	if (!meta_read(img, (unsigned long long)table * 512 + (index % img->entries_per_table) * 4, raw, 4)) {
+		return 0;
+	}
+	grain = le32(raw);
+	if (grain <= 1) {
+		return 1; // 0: no asignado, 1: grano de ceros
+	}
+	ext->offset = (unsigned long long)grain * 512;
+	if (img->zlib_window == 0) {
+		ext->kind = IMAGE_DATA;
+		return 1;
+	}
+	// Los granos comprimidos empiezan con un marcador: LBA (8 bytes) y tamaño (4 bytes)
+	if (!meta_read(img, ext->offset, raw, VMDK_MARKER_SIZE)) {
+		return 0;
+	}
+	ext->kind = IMAGE_COMPRESSED;
+	ext->length = le32(raw + 8);
+	ext->offset += VMDK_MARKER_SIZE;
+	return 1;
+}
+
+static int vmdk_open(disk_image *img, const char *path, const unsigned char *hdr) {
+	unsigned char footer[512];
+	unsigned int flags = le32(hdr + 8);
+	unsigned long long grain = le64(hdr + 20);
+	unsigned long long gd = le64(hdr + 56);
+	unsigned long long descriptor = le64(hdr + 28);
+	unsigned long long descriptor_size = le64(hdr + 36);
+
+	if (gd == VMDK_GD_AT_END) {
+		// streamOptimized: la cabecera válida se repite antes del marcador de fin
+		if (img->file_size < 1536 || !image_pread(img->fd, footer, sizeof(footer), img->file_size - 1024)
+				|| memcmp(footer, "KDMV", 4) != 0) {
+			fprintf(stderr, "Error: La imagen VMDK %s no tiene la cabecera final\n", path);
+			return -1;
+		}
+		hdr = footer;
+		flags = le32(hdr + 8);
+		gd = le64(hdr + 56);
+	}
+	img->entries_per_table = le32(hdr + 44);
+	if (grain < 8 || (grain & (grain - 1)) != 0 || img->entries_per_table == 0 || gd == 0) {
+		fprintf(stderr, "Error: La cabecera VMDK de %s no es valida\n", path);
+		return -1;
+	}
+	if (descriptor != 0 && descriptor_size != 0) {
+		char text[4096];
+		size_t len = descriptor_size * 512 < sizeof(text) - 1 ? descriptor_size * 512 : sizeof(text) - 1;
+		if (image_pread(img->fd, text, len, descriptor * 512)) {
+			text[len] = '\0';
+			if (strstr(text, "parentFileNameHint") != NULL) {
+				fprintf(stderr, "Error: La imagen VMDK %s es diferencial y no se puede leer sin su padre\n", path);
+				return -1;
+			}
+		}
+	}
+	if ((flags & VMDK_FLAG_COMPRESSED) && le16(hdr + 77) != 1) {
+		fprintf(stderr, "Error: La imagen VMDK %s usa un algoritmo de compresion desconocido\n", path);
+		return -1;
+	}
+	img->format = "vmdk";
+	img->size = le64(hdr + 12) * 512;
+	img->block_size = grain * 512;
+	img->table = gd * 512;
+	img->table_entries = (img->size / img->block_size + img->entries_per_table - 1) / img->entries_per_table;
+	img->zlib_window = (flags & VMDK_FLAG_COMPRESSED) ? 15 : 0; // granos con cabecera zlib
+	img->map = vmdk_map;
+	return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int image_open(disk_handle *disk) {
+	unsigned char head[512], tail[512];
+	disk_image *img;
+	int status = 0;
+
+	// Una imagen comprimida puede ocupar menos de un sector
+	if (disk->size_bytes == 0 || !image_pread(disk->fd, head, sizeof(head), 0)) {
+		return 0;
+	}
+	if (!compress_detect(head, sizeof(head))) {
+		if (disk->size_bytes < 512 || !image_pread(disk->fd, tail, sizeof(tail), disk->size_bytes - 512)) {
+			return 0;
+		}
+		if (memcmp(head, "# Disk DescriptorFile", 21) == 0) {
+			fprintf(stderr, "Error: %s es un descriptor VMDK; abra el archivo de su extension de datos\n", disk->path);
+			return -1;
+		}
+	}
+
+	img = (disk_image *)calloc(1, sizeof(disk_image));
+	if (img == NULL) {
+		return -1;
+	}
+	img->fd = disk->fd;
+	img->file_size = disk->size_bytes;
+
+	if (compress_detect(head, sizeof(head))) {
+		status = compress_open(img, disk->path, head, sizeof(head));
+	} else if (memcmp(head, "QFI\xfb", 4) == 0) {
+		status = qcow2_open(img, disk->path, head);
+	} else if (memcmp(head, "vhdxfile", 8) == 0) {
+		status = vhdx_open(img, disk->path);
+	} else if (memcmp(head, "KDMV", 4) == 0) {
+		status = vmdk_open(img, disk->path, head);
+	} else if (memcmp(tail, "conectix", 8) == 0) {
+		status = vhd_open(img, disk->path, tail);
+	} else if (memcmp(head, "conectix", 8) == 0) {
+		// Pie de un VHD dinámico copiado al comienzo (el del final está dañado)
+		status = vhd_open(img, disk->path, head);
+	}
+
+	if (status == 1 && img->zlib_window != 0) {
+		img->zdata = (unsigned char *)malloc(img->block_size);
+		if (img->zdata == NULL) {
+			status = -1;
+		}
+	}
+	if (status != 1) {
+		image_close(img);
+		return status;
+	}
+	disk->image = img;
+	disk->size_bytes = img->size;
+	return 1;
+}
+
+/**
+ * @brief Descomprime el bloque `index` en `zdata`, salvo que ya esté allí.
+ */
+static int load_compressed(disk_image *img, unsigned long long index, const image_extent *ext) {
+	unsigned long long length = ext->length;
+	unsigned char *in;
+	z_stream zs;
+	int ret;
+
+	if (img->zvalid && img->zindex == index) {
+		return 1;
+	}
+	img->zvalid = 0;
+	// Un bloque comprimido nunca ocupa mucho más que el bloque original
+	if (ext->offset >= img->file_size || length == 0 || length > 2 * img->block_size + 1024) {
+		return 0;
+	}
+	if (length > img->file_size - ext->offset) {
+		length = img->file_size - ext->offset;
+	}
+	in = (unsigned char *)malloc((size_t)length);
+	if (in == NULL) {
+		return 0;
+	}
+	if (!image_pread(img->fd, in, (size_t)length, ext->offset)) {
+		free(in);
+		return 0;
+	}
+	memset(&zs, 0, sizeof(zs));
+	if (inflateInit2(&zs, img->zlib_window) != Z_OK) {
+		free(in);
+		return 0;
+	}
+	zs.next_in = in;
+	zs.avail_in = (uInt)length;
+	zs.next_out = img->zdata;
+	zs.avail_out = (uInt)img->block_size;
+	ret = inflate(&zs, Z_FINISH);
+	inflateEnd(&zs);
+	free(in);
+	// qcow2 redondea los datos comprimidos a sectores: el bloque puede llenarse antes del fin del flujo
+	if (ret != Z_STREAM_END && !(ret == Z_BUF_ERROR && zs.avail_out == 0) && !(ret == Z_OK && zs.avail_out == 0)) {
+		return 0;
+	}
+	memset(img->zdata + (img->block_size - zs.avail_out), 0, zs.avail_out);
+	img->zindex = index;
+	img->zvalid = 1;
+	return 1;
+}
+
+int image_read(disk_image *img, char *buf, size_t size, unsigned long long offset) {
+	if (img->size != 0 && (offset > img->size || size > img->size - offset)) {
+		return 0;
+	}
+	if (img->read != NULL) {
+		return img->read(img, buf, size, offset);
+	}
+	while (size > 0) {
+		unsigned long long index = offset / img->block_size;
+		unsigned long long within = offset % img->block_size;
+		size_t n = img->block_size - within < size ? (size_t)(img->block_size - within) : size;
+		image_extent ext;
+
+		if (!img->map(img, index, &ext)) {
+			return 0;
+		}
+		switch (ext.kind) {
+		case IMAGE_ZERO:
+			memset(buf, 0, n);
+			break;
+		case IMAGE_DATA:
+			if (!image_pread(img->fd, buf, n, ext.offset + within)) {
+				return 0;
+			}
+			break;
+		case IMAGE_COMPRESSED:
+			if (!load_compressed(img, index, &ext)) {
+				return 0;
+			}
+			memcpy(buf, img->zdata + within, n);
+			break;
+		}
+		buf += n;
+		offset += n;
+		size -= n;
+	}
+	return 1;
+}
+
+int image_next_data(disk_image *img, unsigned long long offset, unsigned long long limit,
+		unsigned long long *start, unsigned long long *end) {
+	unsigned long long index;
+	image_extent ext;
+
+	if (img->read != NULL) {
+		return -1;
+	}
+	// Saltar los bloques sin asignar: no se lee ningún dato, solo las tablas
+	for (index = offset / img->block_size; index * img->block_size < limit; index++) {
+		if (!img->map(img, index, &ext)) {
+			return -1;
+		}
+		if (ext.kind != IMAGE_ZERO) {
+			break;
+		}
+	}
+	if (index * img->block_size >= limit) {
+		return 0;
+	}
+	*start = index * img->block_size > offset ? index * img->block_size : offset;
+	// Extender el tramo mientras los bloques sigan asignados
+	for (index++; index * img->block_size < limit; index++) {
+		if (!img->map(img, index, &ext)) {
+			return -1;
+		}
+		if (ext.kind == IMAGE_ZERO) {
+			break;
+		}
+	}
+	*end = index * img->block_size < limit ? index * img->block_size : limit;
+	return 1;
+}
+
+void image_close(disk_image *img) {
+	if (img == NULL) {
+		return;
+	}
+	if (img->release != NULL) {
+		img->release(img);
+	}
+	free(img->zdata);
+	free(img);
+}
@@ -0,0 +1,217 @@
+/**
+ * @file image.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Lectura de imágenes de máquinas virtuales (qcow2, VHD, VHDX y VMDK).
+ *
+ * Estos formatos guardan el disco virtual en bloques (clústeres de qcow2,
+ * bloques de VHD/VHDX, granos de VMDK) que se ubican en el archivo mediante
+ * tablas de traducción. Cada lectura se traduce bloque a bloque: los bloques
+ * no asignados se devuelven como ceros sin leer el archivo y los comprimidos
+ * se descomprimen con zlib. Las entradas de las tablas se leen de a un
+ * sector de 512 bytes y se conservan en una caché LRU, de modo que analizar
+ * la tabla de particiones de una imagen grande lee solo unos pocos KB de
+ * metadatos.
+ *
+ * Las imágenes crudas comprimidas (gzip, xz, zstd) se leen descomprimiendo
+ * solo hasta donde se necesita (ver compress.h).
+ *
+ * No se admiten imágenes que dependen de otro archivo (qcow2 con archivo
+ * base, VHD/VHDX diferenciales, VMDK con padre o con el descriptor separado
+ * de los datos) ni imágenes cifradas.
+ * @copyright MIT License
+ */
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stddef.h>
+#include "disk.h"
+
+/**
+ * @def IMAGE_META_SLOTS
+ * @brief Sectores de metadatos que conserva la caché de cada imagen.
+ */
+#define IMAGE_META_SLOTS 16
+
+/**
+ * @def IMAGE_META_SIZE
+ * @brief Tamaño de cada sector de metadatos de la caché.
+ */
+#define IMAGE_META_SIZE 512
+
+/**
+ * @enum image_extent_kind
+ * @brief Ubicación de un bloque del disco virtual dentro del archivo.
+ */
+typedef enum {
+	IMAGE_ZERO = 0,       ///< Bloque no asignado: se lee como ceros.
+	IMAGE_DATA = 1,       ///< Bloque guardado tal cual en el archivo.
+	IMAGE_COMPRESSED = 2  ///< Bloque comprimido con deflate.
+} image_extent_kind;
+
+/**
+ * @struct image_extent
+ * @brief Resultado de traducir un bloque del disco virtual.
+ *
+ * @var image_extent::kind
+ * Ubicación del bloque (ver image_extent_kind).
+ * @var image_extent::offset
+ * Desplazamiento en el archivo del comienzo del bloque o de sus datos comprimidos.
+ * @var image_extent::length
+ * Bytes comprimidos (solo IMAGE_COMPRESSED).
+ */
+typedef struct {
+	image_extent_kind kind;
+	unsigned long long offset;
+	unsigned long long length;
+} image_extent;
+
+/**
+ * @struct image_meta_entry
+ * @brief Sector de metadatos de la caché de traducción.
+ *
+ * @var image_meta_entry::offset
+ * Desplazamiento del sector en el archivo.
+ * @var image_meta_entry::last_use
+ * Marca del último acceso, usada para desalojar la entrada menos reciente.
+ * @var image_meta_entry::valid
+ * 1 si la entrada contiene datos leídos del archivo.
+ * @var image_meta_entry::data
+ * Contenido del sector.
+ */
+typedef struct {
+	unsigned long long offset;
+	unsigned long last_use;
+	int valid;
+	unsigned char data[IMAGE_META_SIZE];
+} image_meta_entry;
+
+typedef struct disk_image disk_image;
+
+/**
+ * @struct disk_image
+ * @brief Imagen de máquina virtual abierta.
+ *
+ * @var disk_image::fd
+ * Descriptor del archivo de la imagen (pertenece al disk_handle).
+ * @var disk_image::format
+ * Nombre del formato ("qcow2", "vhd", "vhdx", "vmdk", "gzip", "xz" o "zstd").
+ * @var disk_image::size
+ * Tamaño del disco virtual en bytes (0 si es desconocido: imagen comprimida
+ * sin índice).
+ * @var disk_image::file_size
+ * Tamaño del archivo de la imagen en bytes.
+ * @var disk_image::sector_size
+ * Tamaño de sector lógico que declara la imagen, o 0 si no lo declara.
+ * @var disk_image::block_size
+ * Unidad de traducción en bytes (clúster, bloque o grano).
+ * @var disk_image::map
+ * Traduce el bloque `index` del disco virtual. Retorna 1 si pudo, 0 si la
+ * tabla de traducción no se pudo leer o es inválida.
+ * @var disk_image::read
+ * Lectura propia del formato, o NULL para traducir bloque a bloque con `map`.
+ * @var disk_image::release
+ * Libera el estado propio del formato, o NULL.
+ * @var disk_image::stream
+ * Estado propio del formato (imágenes comprimidas).
+ * @var disk_image::table
+ * Desplazamiento de la tabla de primer nivel (L1 de qcow2, BAT de VHD y
+ * VHDX, directorio de granos de VMDK).
+ * @var disk_image::table_entries
+ * Cantidad de entradas de la tabla de primer nivel.
+ * @var disk_image::entries_per_table
+ * qcow2: entradas de cada tabla L2. VMDK: entradas de cada tabla de granos.
+ * VHDX: bloques de datos entre dos bloques de mapa de sectores.
+ * @var disk_image::data_skip
+ * VHD: bytes del mapa de sectores que precede a los datos de cada bloque.
+ * @var disk_image::cluster_bits
+ * qcow2: logaritmo en base 2 del tamaño de clúster.
+ * @var disk_image::zlib_window
+ * Parámetro `windowBits` de inflateInit2() para los bloques comprimidos.
+ * @var disk_image::clock
+ * Contador de accesos para la política LRU de la caché de metadatos.
+ * @var disk_image::meta
+ * Sectores de metadatos leídos recientemente.
+ * @var disk_image::zdata
+ * Último bloque descomprimido, o NULL.
+ * @var disk_image::zindex
+ * Índice del bloque contenido en `zdata`.
+ * @var disk_image::zvalid
+ * 1 si `zdata` contiene un bloque.
+ */
+struct disk_image {
+	int fd;
+	const char *format;
+	unsigned long long size;
+	unsigned long long file_size;
+	unsigned int sector_size;
+	unsigned long long block_size;
+	int (*map)(disk_image *img, unsigned long long index, image_extent *ext);
+	int (*read)(disk_image *img, char *buf, size_t size, unsigned long long offset);
+	void (*release)(disk_image *img);
+	void *stream;
+	unsigned long long table;
+	unsigned long long table_entries;
+	unsigned long long entries_per_table;
+	unsigned long long data_skip;
+	unsigned int cluster_bits;
+	int zlib_window;
+	unsigned long clock;
+	image_meta_entry meta[IMAGE_META_SLOTS];
+	unsigned char *zdata;
+	unsigned long long zindex;
+	int zvalid;
+};
+
+/**
+ * @brief Reconoce y abre una imagen de máquina virtual.
+ *
+ * Examina las firmas de los formatos soportados en el archivo ya abierto
+ * por disk_open(). Si lo reconoce, asocia la imagen al manejador
+ * (`disk->image`) y reemplaza `disk->size_bytes` por el tamaño del disco
+ * virtual.
+ *
+ * @param disk Manejador con `fd` y `size_bytes` del archivo.
+ * @return int 1 si el archivo es una imagen y se abrió, 0 si no es una
+ *         imagen de un formato conocido (se lee como disco crudo), -1 si es
+ *         una imagen que no se puede leer (el error ya se informó).
+ */
+int image_open(disk_handle *disk);
+
+/**
+ * @brief Lee bytes del disco virtual.
+ *
+ * @param img Imagen abierta.
+ * @param buf Buffer destino.
+ * @param size Cantidad de bytes.
+ * @param offset Desplazamiento en el disco virtual.
+ * @return int 1 si se leyeron todos los bytes, 0 en caso contrario.
+ */
+int image_read(disk_image *img, char *buf, size_t size, unsigned long long offset);
+
+/**
+ * @brief Busca el siguiente tramo de bloques asignados del disco virtual.
+ *
+ * Solo consulta las tablas de traducción: los bloques sin asignar se leen
+ * como ceros, por lo que no hace falta leerlos ni examinarlos.
+ *
+ * @param img Imagen abierta.
+ * @param offset Desplazamiento desde el que se busca.
+ * @param limit Desplazamiento donde termina la búsqueda.
+ * @param start Comienzo del tramo con datos.
+ * @param end Fin (exclusivo) del tramo con datos, como mucho `limit`.
+ * @return int 1 si se encontró un tramo, 0 si no hay datos entre `offset` y
+ *         `limit`, -1 si el formato no informa los bloques sin asignar
+ *         (imágenes comprimidas) o la tabla no se pudo leer.
+ */
+int image_next_data(disk_image *img, unsigned long long offset, unsigned long long limit,
+		unsigned long long *start, unsigned long long *end);
+
+/**
+ * @brief Libera la imagen. No cierra el descriptor del archivo.
+ *
+ * @param img Imagen abierta con image_open(), o NULL.
+ */
+void image_close(disk_image *img);
+
+#endif
@@ -0,0 +1,214 @@
+/**
+ * @file json.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <string.h>
+#include "json.h"
+#include "dump.h"
+
+static const char json_digits[] = "0123456789abcdef";
+
+/**
+ * @brief Escribe el contenido del buffer y lo deja vacío.
+ */
+static void json_flush(json_writer *w) {
+	if (w->len > 0 && !dump_write(w->out, w->buf, w->len)) {
+		w->error = 1;
+	}
+	w->len = 0;
+}
+
+/**
+ * @brief Garantiza que quepan `n` bytes más en el buffer.
+ */
+static void json_reserve(json_writer *w, size_t n) {
+	if (w->len + n > JSON_BUFFER_SIZE) {
+		json_flush(w);
+	}
+}
+
+static void json_put(json_writer *w, const char *data, size_t n) {
+	while (n > 0) {
+		size_t chunk;
+		json_reserve(w, 1);
+		chunk = JSON_BUFFER_SIZE - w->len < n ? JSON_BUFFER_SIZE - w->len : n;
+		memcpy(w->buf + w->len, data, chunk);
+		w->len += chunk;
+		data += chunk;
+		n -= chunk;
+	}
+}
+
+static void json_put_char(json_writer *w, char c) {
+	json_reserve(w, 1);
+	w->buf[w->len++] = c;
+}
+
+/**
+ * @brief Longitud de la secuencia UTF-8 válida que empieza en `p`.
+ *
+ * Rechaza las secuencias truncadas, las codificaciones demasiado largas,
+ * los sustitutos (U+D800 a U+DFFF) y los valores mayores que U+10FFFF.
+ *
+ * @return 2 a 4, o 0 si el byte no empieza una secuencia válida.
+ */
+static size_t json_utf8_len(const unsigned char *p) {
+	unsigned char low = 0x80, high = 0xBF; // Rango del segundo byte
+	size_t n;
+
+	if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+		n = 2;
+	} else if (p[0] >= 0xE0 && p[0] <= 0xEF) {
+		n = 3;
+		low = p[0] == 0xE0 ? 0xA0 : 0x80;
+		high = p[0] == 0xED ? 0x9F : 0xBF;
+	} else if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+		n = 4;
+		low = p[0] == 0xF0 ? 0x90 : 0x80;
+		high = p[0] == 0xF4 ? 0x8F : 0xBF;
+	} else {
+		return 0;
+	}
+	if (p[1] < low || p[1] > high) {
+		return 0;
+	}
+	// El '\0' final no es un byte de continuación, así que no se lee más allá
+	for (size_t i = 2; i < n; i++) {
+		if ((p[i] & 0xC0) != 0x80) {
+			return 0;
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief Escribe una cadena JSON entre comillas.
+ *
+ * Los bytes que no forman UTF-8 válido (etiquetas o rutas con otra
+ * codificación) se reemplazan por U+FFFD, de modo que el registro siempre
+ * es JSON válido.
+ */
+static void json_put_quoted(json_writer *w, const char *s) {
+	json_put_char(w, '"');
+	for (const unsigned char *p = (const unsigned char *)s; *p != '\0'; p++) {
+		// El peor caso es una secuencia \u00XX
+		json_reserve(w, 6);
+		char *dst = w->buf + w->len;
+		if (*p >= 0x80) {
+			size_t n = json_utf8_len(p);
+			if (n == 0) {
+				memcpy(dst, "\\ufffd", 6);
+				w->len += 6;
+			} else {
+				memcpy(dst, p, n);
+				w->len += n;
+				p += n - 1;
+			}
+		} else if (*p == '"' || *p == '\\') {
+			dst[0] = '\\';
+			dst[1] = (char)*p;
+			w->len += 2;
+		} else if (*p < 0x20) {
+			memcpy(dst, "\\u00", 4);
+			dst[4] = json_digits[*p >> 4];
+			dst[5] = json_digits[*p & 0x0f];
+			w->len += 6;
+		} else {
+			dst[0] = (char)*p;
+			w->len++;
+		}
+	}
+	json_put_char(w, '"');
+}
+
+/**
+ * @brief Escribe la coma de separación y, si corresponde, el nombre del miembro.
+ */
+static void json_member(json_writer *w, const char *key) {
+	if (w->depth > 0) {
+		if (!w->first[w->depth - 1]) {
+			json_put_char(w, ',');
+		}
+		w->first[w->depth - 1] = 0;
+	}
+	if (key != NULL) {
+		json_put_quoted(w, key);
+		json_put_char(w, ':');
+	}
+}
+
+static void json_open(json_writer *w, const char *key, char bracket) {
+	json_member(w, key);
+	json_put_char(w, bracket);
+	if (w->depth == JSON_MAX_DEPTH) {
+		w->error = 1;
+		return;
+	}
+	w->first[w->depth++] = 1;
+}
+
+static void json_close(json_writer *w, char bracket) {
+	if (w->depth > 0) {
+		w->depth--;
+	}
+	json_put_char(w, bracket);
+}
+
+void json_init(json_writer *w, FILE *out) {
+	w->out = out;
+	w->len = 0;
+	w->depth = 0;
+	w->error = 0;
+}
+
+void json_begin_object(json_writer *w, const char *key) {
+	json_open(w, key, '{');
+}
+
+void json_end_object(json_writer *w) {
+	json_close(w, '}');
+}
+
+void json_begin_array(json_writer *w, const char *key) {
+	json_open(w, key, '[');
+}
+
+void json_end_array(json_writer *w) {
+	json_close(w, ']');
+}
+
+void json_string(json_writer *w, const char *key, const char *value) {
+	json_member(w, key);
+	json_put_quoted(w, value);
+}
+
+void json_uint(json_writer *w, const char *key, unsigned long long value) {
+	char digits[20];
+	int n = 0;
+
+	json_member(w, key);
+	// Convertir a decimal de derecha a izquierda
+	do {
+		digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	json_put(w, digits + sizeof(digits) - n, (size_t)n);
+}
+
+void json_bool(json_writer *w, const char *key, int value) {
+	json_member(w, key);
+	if (value) {
+		json_put(w, "true", 4);
+	} else {
+		json_put(w, "false", 5);
+	}
+}
+
+int json_end_record(json_writer *w) {
+	json_put_char(w, '\n');
+	json_flush(w);
+	w->depth = 0;
+	return !w->error;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file json.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Escritura de registros JSON en un buffer preasignado.
+ *
+ * Cada registro se construye directamente en el buffer del escritor, sin
+ * cadenas intermedias, y se escribe con una sola llamada al terminarlo
+ * (una línea por registro, formato NDJSON). Si un registro no cabe en el
+ * buffer, se escribe por partes.
+ * @copyright MIT License
+ */
+#ifndef JSON_H
+#define JSON_H
+
+#include <stdio.h>
+
+/**
+ * @def JSON_BUFFER_SIZE
+ * @brief Capacidad del buffer de un escritor JSON.
+ */
+#define JSON_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @def JSON_MAX_DEPTH
+ * @brief Profundidad máxima de anidamiento de objetos y arreglos.
+ */
+#define JSON_MAX_DEPTH 16
+
+/**
+ * @struct json_writer
+ * @brief Escritor de registros JSON.
+ *
+ * @var json_writer::out
+ * Flujo donde se escriben los registros.
+ * @var json_writer::len
+ * Bytes ocupados del buffer.
+ * @var json_writer::depth
+ * Nivel de anidamiento actual.
+ * @var json_writer::first
+ * Por nivel, 1 si todavía no se escribió ningún elemento (no hace falta coma).
+ * @var json_writer::error
+ * 1 si falló alguna escritura o se excedió la profundidad máxima.
+ * @var json_writer::buf
+ * Buffer donde se construye el registro.
+ */
+typedef struct {
+	FILE *out;
+	size_t len;
+	int depth;
+	int first[JSON_MAX_DEPTH];
+	int error;
+	char buf[JSON_BUFFER_SIZE];
+} json_writer;
+
+/**
+ * @brief Prepara un escritor para emitir registros en `out`.
+ */
+void json_init(json_writer *w, FILE *out);
+
+/**
+ * @brief Abre un objeto.
+ *
+ * @param w Escritor.
+ * @param key Nombre del miembro, o NULL si el objeto es un elemento de un
+ *            arreglo o el registro completo.
+ */
+void json_begin_object(json_writer *w, const char *key);
+
+/**
+ * @brief Cierra el objeto abierto más reciente.
+ */
+void json_end_object(json_writer *w);
+
+/**
+ * @brief Abre un arreglo.
+ *
+ * @param w Escritor.
+ * @param key Nombre del miembro, o NULL si el arreglo es un elemento de otro arreglo.
+ */
+void json_begin_array(json_writer *w, const char *key);
+
+/**
+ * @brief Cierra el arreglo abierto más reciente.
+ */
+void json_end_array(json_writer *w);
+
+/**
+ * @brief Escribe una cadena, escapando los caracteres que JSON requiere.
+ *
+ * @param w Escritor.
+ * @param key Nombre del miembro, o NULL dentro de un arreglo.
+ * @param value Cadena terminada en '\0'; los bytes que no forman UTF-8
+ *              válido se escriben como U+FFFD.
+ */
+void json_string(json_writer *w, const char *key, const char *value);
+
+/**
+ * @brief Escribe un entero sin signo.
+ */
+void json_uint(json_writer *w, const char *key, unsigned long long value);
+
+/**
+ * @brief Escribe un valor lógico (`true` si `value` es distinto de 0).
+ */
+void json_bool(json_writer *w, const char *key, int value);
+
+/**
+ * @brief Termina el registro con un salto de línea y lo escribe.
+ *
+ * @param w Escritor.
+ * @return int 1 si el registro se escribió completo, 0 en caso de error.
+ */
+int json_end_record(json_writer *w);
+
+#endif
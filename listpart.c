@@ -0,0 +1,266 @@
+/**
+ * @file listpart.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "listpart.h"
+
+/**
+ * @brief Reserva la siguiente entrada del resultado.
+ *
+ * @return Entrada donde guardar la partición, o NULL si el arreglo del
+ *         llamador está lleno (la partición solo se cuenta en `total`).
+ */
+static listpart_partition *next_partition(listpart_result *result) {
+	result->total++;
+	if (result->count == result->capacity) {
+		return NULL;
+	}
+	listpart_partition *part = &result->partitions[result->count++];
+	memset(part, 0, sizeof(listpart_partition));
+	return part;
+}
+
+/**
+ * @brief Agrega una partición MBR (primaria o lógica) al resultado.
+ */
+static void add_mbr_partition(listpart_result *result, const mbr_partition_descriptor *desc, unsigned int number,
+		unsigned long long start_lba) {
+	listpart_partition *part = next_partition(result);
+	if (part == NULL) {
+		return;
+	}
+	part->number = number;
+	part->start_lba = start_lba;
+	part->end_lba = start_lba + desc->size - 1;
+	part->sectors = desc->size;
+	part->size_bytes = (unsigned long long)desc->size * result->sector_size;
+	part->type_name = mbr_partition_type_name(desc->partition_type);
+	part->mbr_type = desc->partition_type;
+	part->boot = desc->boot_flag == 0x80;
+	memcpy(part->chs_start, desc->chs_start, sizeof(part->chs_start));
+	memcpy(part->chs_end, desc->chs_end, sizeof(part->chs_end));
+	part->extended = is_extended_partition(desc->partition_type);
+}
+
+static void parse_mbr(disk_handle *disk, listpart_result *result) {
+	const mbr *boot_record = &result->boot_record;
+	unsigned int number = 5;
+
+	for (int i = 0; i < 4; i++) {
+		const mbr_partition_descriptor *desc = &boot_record->partition_table[i];
+		if (desc->partition_type != MBR_TYPE_UNUSED) {
+			add_mbr_partition(result, desc, (unsigned int)i + 1, desc->start_lba);
+		}
+	}
+
+	// Particiones lógicas de cada partición extendida, en el orden de la cadena EBR
+	for (int i = 0; i < 4; i++) {
+		const mbr_partition_descriptor *desc = &boot_record->partition_table[i];
+		if (!is_extended_partition(desc->partition_type)) {
+			continue;
+		}
+		mbr_logical_partition logical[MBR_MAX_LOGICAL_PARTITIONS];
+		int count = mbr_read_logical_partitions(disk, desc, logical, MBR_MAX_LOGICAL_PARTITIONS);
+		for (int j = 0; j < count; j++) {
+			unsigned int first = result->count;
+			add_mbr_partition(result, &logical[j].entry, number++, logical[j].start_lba);
+			if (result->count > first) {
+				result->partitions[first].logical = 1;
+				result->partitions[first].ebr_lba = logical[j].ebr_lba;
+			}
+		}
+	}
+}
+
+static int parse_gpt(disk_handle *disk, int flags, listpart_result *result) {
+	gpt_table primary, backup;
+
+	gpt_load_tables(disk, (flags & LISTPART_CHECK_BACKUP) != 0, &primary, &backup);
+	gpt_table *table = primary.header_valid ? &primary : &backup;
+	if (!primary.header_read) {
+		result->error = "No se pudo leer la cabecera GPT";
+	} else if (!primary.header_valid && !backup.header_valid) {
+		result->error = "Cabecera GPT invalida";
+	} else if (table->entries == NULL) {
+		result->error = "No se pudo leer el arreglo de descriptores GPT";
+	}
+	if (result->error != NULL) {
+		gpt_free_table(&primary);
+		gpt_free_table(&backup);
+		return 0;
+	}
+
+	const gpt_header *hdr = &table->header;
+	result->gpt_header = *hdr;
+	result->gpt_primary_header_valid = primary.header_valid;
+	result->gpt_header_from_backup = table == &backup;
+	result->gpt_entries_valid = table->entries_valid;
+	result->gpt_backup_read = backup.header_read;
+	result->gpt_backup_header_valid = backup.header_valid;
+	result->gpt_backup_entries_valid = backup.entries_valid;
+	if (flags & LISTPART_CHECK_BACKUP) {
+		result->gpt_differences = gpt_compare_tables(NULL, &primary, &backup);
+	}
+
+	for (unsigned int j = 0; j < hdr->num_partition_entries; j++) {
+		gpt_partition_descriptor *desc =
+			(gpt_partition_descriptor *)(table->entries + (size_t)j * hdr->size_partition_entry);
+		if (is_null_descriptor(desc)) {
+			continue;
+		}
+		listpart_partition *part = next_partition(result);
+		if (part == NULL) {
+			continue;
+		}
+		const gpt_partition_type *type = gpt_partition_type_by_guid(&desc->partition_type_guid);
+		part->number = j;
+		part->start_lba = desc->starting_lba;
+		part->end_lba = desc->ending_lba;
+		part->sectors = desc->ending_lba - desc->starting_lba + 1;
+		part->size_bytes = part->sectors * result->sector_size;
+		part->type_name = type->description;
+		part->type_os = type->os;
+		part->type_guid = desc->partition_type_guid;
+		memcpy(&part->unique_guid, desc->unique_partition_guid, sizeof(guid));
+		part->attributes = desc->attributes;
+		gpt_decode_partition_name(desc->partition_name, part->name);
+	}
+
+	gpt_free_table(&primary);
+	gpt_free_table(&backup);
+	return 1;
+}
+
+void listpart_result_init(listpart_result *result, listpart_partition *storage, unsigned int capacity) {
+	memset(result, 0, sizeof(listpart_result));
+	result->partitions = storage;
+	result->capacity = storage != NULL ? capacity : 0;
+	result->gpt_differences = -1;
+}
+
+/**
+ * @brief Cuenta los bytes con datos de cada partición, si el disco informa sus huecos.
+ */
+static void count_allocated(disk_handle *disk, listpart_result *result) {
+	unsigned long long data_start, data_end;
+
+	if (disk_next_data(disk, 0, &data_start, &data_end) < 0) {
+		return;
+	}
+	for (unsigned int i = 0; i < result->count; i++) {
+		listpart_partition *part = &result->partitions[i];
+		if (!disk_allocated(disk, part->start_lba, part->sectors, &part->allocated_bytes)) {
+			return;
+		}
+	}
+	result->allocated_known = 1;
+}
+
+int listpart_parse_disk(disk_handle *disk, int flags, listpart_result *result) {
+	char sector[DISK_MAX_SECTOR_SIZE];
+
+	// Descartar lo que haya dejado un análisis anterior con el mismo resultado
+	listpart_result_init(result, result->partitions, result->capacity);
+	result->sector_size = disk->sector_size;
+	result->physical_sector_size = disk->physical_sector_size;
+	result->size_bytes = disk->size_bytes;
+
+	if (!read_lba_sector(disk, 0, sector)) {
+		result->error = "No se pudo leer el primer sector";
+		return 0;
+	}
+	memcpy(&result->boot_record, sector, sizeof(mbr));
+	result->boot_record_read = 1;
+
+	switch (is_mbr(&result->boot_record)) {
+	case 2:
+		result->scheme = LISTPART_SCHEME_GPT;
+		if (!parse_gpt(disk, flags, result)) {
+			return 0;
+		}
+		break;
+	case 1:
+		result->scheme = LISTPART_SCHEME_MBR;
+		parse_mbr(disk, result);
+		break;
+	default:
+		result->scheme = LISTPART_SCHEME_UNKNOWN;
+		return 1;
+	}
+	count_allocated(disk, result);
+	if (flags & LISTPART_PROBE_FS) {
+		listpart_probe_filesystems(disk, result->partitions, result->count);
+	}
+	return 1;
+}
+
+int listpart_probe_filesystems(disk_handle *disk, listpart_partition *parts, unsigned int count) {
+	fsprobe_request *reqs;
+	int n = 0;
+	int ok;
+
+	if (count == 0) {
+		return 1;
+	}
+	reqs = (fsprobe_request *)malloc(count * sizeof(fsprobe_request));
+	if (reqs == NULL) {
+		return 0;
+	}
+	for (unsigned int i = 0; i < count; i++) {
+		memset(&parts[i].fs, 0, sizeof(fsprobe_info));
+		if (parts[i].extended) {
+			continue;
+		}
+		reqs[n].start_lba = parts[i].start_lba;
+		reqs[n].sectors = parts[i].sectors;
+		reqs[n].info = &parts[i].fs;
+		n++;
+	}
+	ok = fsprobe_partitions(disk, reqs, n);
+	free(reqs);
+	return ok;
+}
+
+int listpart_parse_device(const char *path, int flags, listpart_result *result) {
+	disk_handle disk;
+	int ok;
+
+	if (!disk_open_flags(&disk, path, (flags & LISTPART_DIRECT) ? DISK_OPEN_DIRECT : 0)) {
+		listpart_result_init(result, result->partitions, result->capacity);
+		result->error = "No se pudo abrir el dispositivo";
+		return 0;
+	}
+	ok = listpart_parse_disk(&disk, flags, result);
+	disk_close(&disk);
+	return ok;
+}
+
+int listpart_parse_buffer(const void *data, size_t size, unsigned int sector_size, int flags,
+		listpart_result *result) {
+	disk_handle disk;
+	int ok;
+
+	if (!disk_open_memory(&disk, data, size, sector_size)) {
+		listpart_result_init(result, result->partitions, result->capacity);
+		result->error = "Tamano de sector invalido";
+		return 0;
+	}
+	ok = listpart_parse_disk(&disk, flags, result);
+	disk_close(&disk);
+	return ok;
+}
+
+const char *listpart_scheme_name(listpart_scheme scheme) {
+	switch (scheme) {
+	case LISTPART_SCHEME_MBR:
+		return "mbr";
+	case LISTPART_SCHEME_GPT:
+		return "gpt";
+	default:
+		return "unknown";
+	}
+}
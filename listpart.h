@@ -0,0 +1,264 @@
+/**
+ * @file listpart.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Interfaz de la biblioteca liblistpart: análisis sin impresión.
+ *
+ * Analiza un dispositivo, una imagen o un disco en memoria y deja el
+ * resultado en estructuras planas: esquema, cabecera y particiones con su
+ * tipo y nombre ya decodificados. La biblioteca no imprime los resultados;
+ * la presentación está en una capa aparte (print.h). Los errores de lectura
+ * y de apertura de imágenes y las advertencias sobre estructuras inválidas
+ * (cabeceras GPT, cadenas EBR) sí se escriben en stderr; en el resultado
+ * solo consta, en `error`, el que impide completar el análisis.
+ *
+ * Las funciones son reentrantes: no usan estado global modificable (las
+ * tablas internas se inicializan una sola vez con pthread_once) y pueden
+ * llamarse desde varios hilos con resultados distintos. Las particiones se
+ * guardan en un arreglo que provee el llamador; la biblioteca solo reserva
+ * memoria temporal que libera antes de retornar.
+ * @copyright MIT License
+ */
+#ifndef LISTPART_H
+#define LISTPART_H
+
+#include <stddef.h>
+#include "disk.h"
+#include "mbr.h"
+#include "gpt.h"
+#include "fsprobe.h"
+
+/**
+ * @def LISTPART_CHECK_BACKUP
+ * @brief Opción de análisis: leer siempre la tabla GPT de respaldo y compararla con la primaria.
+ */
+#define LISTPART_CHECK_BACKUP 0x1
+
+/**
+ * @def LISTPART_PROBE_FS
+ * @brief Opción de análisis: identificar el sistema de archivos de cada partición (ver fsprobe.h).
+ */
+#define LISTPART_PROBE_FS 0x2
+
+/**
+ * @def LISTPART_DIRECT
+ * @brief Opción de análisis: leer el dispositivo con O_DIRECT, sin pasar por la caché de páginas (ver disk_open_flags()).
+ */
+#define LISTPART_DIRECT 0x4
+
+/**
+ * @enum listpart_scheme
+ * @brief Esquema de particionado detectado.
+ */
+typedef enum {
+	LISTPART_SCHEME_UNKNOWN = 0, ///< El primer sector no tiene la firma MBR.
+	LISTPART_SCHEME_MBR = 1,     ///< MBR tradicional, con sus particiones lógicas.
+	LISTPART_SCHEME_GPT = 2      ///< GPT con MBR de protección.
+} listpart_scheme;
+
+/**
+ * @struct listpart_partition
+ * @brief Partición encontrada en el disco.
+ *
+ * @var listpart_partition::number
+ * MBR: 1 a 4 para las primarias y desde 5 para las lógicas, en el orden de
+ * la cadena EBR. GPT: posición del descriptor en el arreglo.
+ * @var listpart_partition::start_lba
+ * Primer sector de la partición.
+ * @var listpart_partition::end_lba
+ * Último sector de la partición.
+ * @var listpart_partition::sectors
+ * Cantidad de sectores.
+ * @var listpart_partition::size_bytes
+ * Tamaño en bytes.
+ * @var listpart_partition::type_name
+ * Descripción del tipo (cadena constante de la biblioteca).
+ * @var listpart_partition::type_os
+ * GPT: sistema operativo asociado al tipo. MBR: NULL.
+ * @var listpart_partition::mbr_type
+ * MBR: código del tipo de partición.
+ * @var listpart_partition::boot
+ * MBR: 1 si la partición está marcada como activa.
+ * @var listpart_partition::chs_start
+ * MBR: dirección CHS de inicio, tal como está en el descriptor.
+ * @var listpart_partition::chs_end
+ * MBR: dirección CHS de fin, tal como está en el descriptor.
+ * @var listpart_partition::extended
+ * MBR: 1 si es una partición extendida.
+ * @var listpart_partition::logical
+ * MBR: 1 si es una partición lógica de la cadena EBR.
+ * @var listpart_partition::ebr_lba
+ * MBR: LBA del EBR que describe la partición lógica.
+ * @var listpart_partition::type_guid
+ * GPT: GUID del tipo.
+ * @var listpart_partition::unique_guid
+ * GPT: GUID único de la partición.
+ * @var listpart_partition::attributes
+ * GPT: atributos.
+ * @var listpart_partition::name
+ * GPT: nombre decodificado a UTF-8. MBR: cadena vacía.
+ * @var listpart_partition::fs
+ * Sistema de archivos, etiqueta y UUID; solo con LISTPART_PROBE_FS (si no,
+ * `fs.type` es NULL).
+ * @var listpart_partition::allocated_bytes
+ * Bytes de la partición que no son huecos; solo si `allocated_known` del
+ * resultado es 1 (ver disk_allocated()).
+ */
+typedef struct {
+	unsigned int number;
+	unsigned long long start_lba;
+	unsigned long long end_lba;
+	unsigned long long sectors;
+	unsigned long long size_bytes;
+	const char *type_name;
+	const char *type_os;
+	unsigned char mbr_type;
+	int boot;
+	unsigned char chs_start[3];
+	unsigned char chs_end[3];
+	int extended;
+	int logical;
+	unsigned long long ebr_lba;
+	guid type_guid;
+	guid unique_guid;
+	unsigned long long attributes;
+	char name[GPT_NAME_LEN];
+	fsprobe_info fs;
+	unsigned long long allocated_bytes;
+} listpart_partition;
+
+/**
+ * @struct listpart_result
+ * @brief Resultado del análisis de un disco.
+ *
+ * Se prepara con listpart_result_init(), que asocia el arreglo de
+ * particiones del llamador.
+ *
+ * @var listpart_result::scheme
+ * Esquema detectado.
+ * @var listpart_result::sector_size
+ * Tamaño de sector lógico en bytes.
+ * @var listpart_result::physical_sector_size
+ * Tamaño de sector físico en bytes.
+ * @var listpart_result::size_bytes
+ * Tamaño del disco en bytes (0 si es desconocido).
+ * @var listpart_result::boot_record_read
+ * 1 si se pudo leer el primer sector.
+ * @var listpart_result::boot_record
+ * Primer sector del disco (MBR o MBR de protección).
+ * @var listpart_result::gpt_header
+ * GPT: cabecera usada (la primaria o, si es inválida, la de respaldo).
+ * @var listpart_result::gpt_primary_header_valid
+ * GPT: 1 si la cabecera primaria es válida.
+ * @var listpart_result::gpt_header_from_backup
+ * GPT: 1 si `gpt_header` proviene de la tabla de respaldo.
+ * @var listpart_result::gpt_entries_valid
+ * GPT: 1 si el arreglo de descriptores usado coincide con su CRC32.
+ * @var listpart_result::gpt_backup_read
+ * GPT: 1 si se leyó la cabecera de respaldo.
+ * @var listpart_result::gpt_backup_header_valid
+ * GPT: 1 si la cabecera de respaldo es válida.
+ * @var listpart_result::gpt_backup_entries_valid
+ * GPT: 1 si el arreglo de respaldo coincide con su CRC32.
+ * @var listpart_result::gpt_differences
+ * GPT: diferencias entre la tabla primaria y la de respaldo, o -1 si no se compararon.
+ * @var listpart_result::allocated_known
+ * 1 si el disco informa sus huecos (imagen cruda dispersa o de máquina
+ * virtual) y se completó `allocated_bytes` de cada partición.
+ * @var listpart_result::partitions
+ * Arreglo del llamador donde se guardan las particiones.
+ * @var listpart_result::capacity
+ * Capacidad de `partitions`.
+ * @var listpart_result::count
+ * Particiones guardadas en `partitions`.
+ * @var listpart_result::total
+ * Particiones encontradas; si supera `capacity`, el llamador puede repetir
+ * el análisis con un arreglo de `total` elementos.
+ * @var listpart_result::error
+ * Descripción del error que impidió terminar el análisis, o NULL.
+ */
+typedef struct {
+	listpart_scheme scheme;
+	unsigned int sector_size;
+	unsigned int physical_sector_size;
+	unsigned long long size_bytes;
+	int boot_record_read;
+	mbr boot_record;
+	gpt_header gpt_header;
+	int gpt_primary_header_valid;
+	int gpt_header_from_backup;
+	int gpt_entries_valid;
+	int gpt_backup_read;
+	int gpt_backup_header_valid;
+	int gpt_backup_entries_valid;
+	int gpt_differences;
+	int allocated_known;
+	listpart_partition *partitions;
+	unsigned int capacity;
+	unsigned int count;
+	unsigned int total;
+	const char *error;
+} listpart_result;
+
+/**
+ * @brief Prepara un resultado vacío que guardará las particiones en `storage`.
+ *
+ * @param result Resultado a inicializar.
+ * @param storage Arreglo de particiones del llamador (puede ser NULL si `capacity` es 0).
+ * @param capacity Cantidad de elementos de `storage`.
+ */
+void listpart_result_init(listpart_result *result, listpart_partition *storage, unsigned int capacity);
+
+/**
+ * @brief Analiza un disco ya abierto.
+ *
+ * @param disk Manejador abierto con disk_open() o disk_open_memory().
+ * @param flags Opciones (LISTPART_CHECK_BACKUP, LISTPART_PROBE_FS).
+ * @param result Resultado preparado con listpart_result_init().
+ * @return int 1 si el análisis terminó, 0 si ocurrió un error (ver `result->error`).
+ */
+int listpart_parse_disk(disk_handle *disk, int flags, listpart_result *result);
+
+/**
+ * @brief Abre un dispositivo o imagen, lo analiza y lo cierra.
+ *
+ * @param path Ruta del dispositivo o archivo.
+ * @param flags Opciones (LISTPART_CHECK_BACKUP, LISTPART_PROBE_FS).
+ * @param result Resultado preparado con listpart_result_init().
+ * @return int 1 si el análisis terminó, 0 si ocurrió un error (ver `result->error`).
+ */
+int listpart_parse_device(const char *path, int flags, listpart_result *result);
+
+/**
+ * @brief Analiza un disco que está completo en memoria.
+ *
+ * @param data Contenido del disco.
+ * @param size Tamaño de `data` en bytes.
+ * @param sector_size Tamaño de sector lógico, o 0 para detectarlo.
+ * @param flags Opciones (LISTPART_CHECK_BACKUP, LISTPART_PROBE_FS).
+ * @param result Resultado preparado con listpart_result_init().
+ * @return int 1 si el análisis terminó, 0 si ocurrió un error (ver `result->error`).
+ */
+int listpart_parse_buffer(const void *data, size_t size, unsigned int sector_size, int flags,
+		listpart_result *result);
+
+/**
+ * @brief Identifica el sistema de archivos de un conjunto de particiones.
+ *
+ * Las particiones extendidas (contenedores de la cadena EBR) se omiten.
+ * listpart_parse_disk() la usa con LISTPART_PROBE_FS; también sirve para
+ * particiones armadas por el llamador.
+ *
+ * @param disk Dispositivo que contiene las particiones.
+ * @param parts Particiones; se completa el campo `fs` de cada una.
+ * @param count Cantidad de particiones.
+ * @return int 1 si todas las lecturas terminaron bien, 0 en caso contrario.
+ */
+int listpart_probe_filesystems(disk_handle *disk, listpart_partition *parts, unsigned int count);
+
+/**
+ * @brief Nombre corto de un esquema: "mbr", "gpt" o "unknown".
+ */
+const char *listpart_scheme_name(listpart_scheme scheme);
+
+#endif
@@ -1,224 +1,552 @@
-/**
- * @file main.c
- * @author 
- *
- * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
- * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
- * @author Erwin Meza Vega <emezav@unicauca.edu.co>
- * @brief Programa para listar particiones de discos con esquemas MBR/GPT.
- * 
- * Este programa accede directamente a dispositivos de bloque y analiza
- * el primer sector para determinar el esquema de partición. Proporciona
- * herramientas para visualizar los datos en formato hexadecimal y ASCII.
- * 
- * @copyright MIT License
- */
-
-
-#include <fcntl.h>
-#include <math.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#ifdef _WIN32
-#include <windows.h>
-#else
-#include <unistd.h>
-#include <fcntl.h>
-#endif
-
-#include "mbr.h"
-#include "gpt.h"
-#define SECTOR_SIZE 512 ///< Tamaño estándar de un sector de disco (512 bytes).
-
-/**
- * @brief Muestra el contenido de un buffer en formato hexadecimal.
- * 
- * Esta función imprime los datos de un buffer en formato hexadecimal
- * y su representación ASCII correspondiente.
- * 
- * @param buf Puntero al buffer que contiene los datos a imprimir.
- * @param size Tamaño del buffer.
- */
-void hex_dump(char *buf, size_t size);
-
-/**
- * @brief Muestra el contenido de un buffer en formato ASCII.
- * 
- * Los caracteres no imprimibles son sustituidos por un punto (`.`).
- * 
- * @param buf Puntero al buffer que contiene los datos a imprimir.
- * @param size Tamaño del buffer.
- */
-void ascii_dump(char *buf, size_t size);
-
-/**
- * @brief Lee un sector específico de un disco y lo almacena en un buffer.
- * 
- * Esta función accede al disco o dispositivo especificado y lee un sector
- * lógico identificado por el número LBA (Logical Block Address). El contenido
- * del sector leído se almacena en el buffer proporcionado.
- * 
- * @param disk Puntero a un archivo o dispositivo de bloque donde se encuentra el disco.
- * @param lba Número lógico de bloque (LBA) que identifica el sector a leer.
- *            Este es un valor entero que representa la dirección lógica
- *            del sector en el disco.
- * @param buf Buffer de memoria donde se almacenará el contenido del sector leído.
- * 
- * @return int 1 si la lectura fue exitosa, 0 si ocurrió un error.
- */
-int read_lba_sector(char *disk, unsigned long long lba, char buf[SECTOR_SIZE]);
-
-
-int main(int argc, char *argv[]) {
-
-	// 1. Validar los argumentos de línea de comandos
-    if (argc < 2) {
-        fprintf(stderr, "Uso: %s <dispositivo>\n", argv[0]);
-        exit(EXIT_FAILURE);
-    }
-	char * disk;
-	
-	// 2.1 Leer el primer sector del disco especificado
-
-	// Iterar sobre los dispositivos pasados como argumentos
-	for(int i=1 ; i<argc; i++){
-		mbr boot_record; // Estructura para almacenar datos del MBR
-		disk=argv[i]; // Nombre del archivo o dispositivo actual
-		
-		printf("\nAnalizando dispositivo: %s\n", disk);
-		// 2.1 Leer el primer sector del disco especificado
-		// 2.2 Si la lectura falla imprimir error y terminar.
-		if(read_lba_sector(disk,0, (char*)&boot_record)==0){
-			fprintf(stderr, "Error: No se pudo abrir el dispositivo %s\n", disk);
-			continue;//Salta al siguiente dispositivo
-		}
-
-		// Imprimir el contenido del primer sector en formato hexadecimal
-		printf("Contenido del primer sector del disco:%s:\n", disk);
-		hex_dump((char*)&boot_record, sizeof(mbr));
-		//PRE: se pudo leer el primer sector del disco
-		//3.Imprimir la tabla de particiones MBR leido
-
-		// Paso 3.1Verificar si el MBR es válido
-		if (is_mbr(&boot_record)==0) {
-			fprintf(stderr, "Advertencia: El sector de arranque del dispositivo %s no contiene una firma válida.\n", disk);
-			continue; // Saltar al siguiente dispositivo
-		}
-		printf("La firma del MBR es valida. Analizando el disco...\n");
-
-		// 4. Si el esquema de particiones es MBR: terminar
-		// 4.1 Determinar el esquema de partición (MBR o GPT)
-		if(is_mbr(&boot_record)==2) {
-			printf("El esquema de particion es GPT con mbr de proteccion. Procediendo a imprimir la tabla GPT...\n");
-			
-			gpt_header hdr;
-			//Validar si se puede abrir el dispositivo
-			if( read_lba_sector(disk, 1, (char*)&hdr) == 0){
-				fprintf(stderr, "No se pudo acceder al dispositivo%s\n", disk);
-				exit(EXIT_FAILURE); 
-			}
-			//Validar que sesa valido el encabezado GPT
-			if(!is_valid_gpt_header(&hdr)){
-				fprintf(stderr, "Cabecera gpt invalida\n");
-				exit(EXIT_FAILURE);
-			}
-			//Imprime la tabla de mbr de protección
-			print_gpt_protective_mbr_table(&boot_record);
-			// En el PTHDR se encuentra la cantidad de descriptores de la tabla
-			print_gpt_header(&hdr);
-			int num_desc = hdr.num_partition_entries;
-			int num_sect_desc = num_desc/4;
-			printf("\nStart LBA       End LBA         Size            Type                            Partition Name\n");
-    		printf("------------    ------------    ------------    ------------------------------   --------------------\n");
-			//Repetir por cada sector descriptor
-			for(int i=0;i < num_sect_desc;i++){
-				//Leer el sector
-				gpt_partition_descriptor desc[4];
-				if( read_lba_sector(disk, 2 + i, (char *)desc) == 0){
-					fprintf(stderr, "No se puede acceder al dispotivo %s\n", disk);
-					exit(EXIT_FAILURE); 
-				}
-				//Ahora por cada descriptor imprimimos su info
-				for(int j=0; j<4; j++){
-					if(is_null_descriptor(&desc[j])){
-						continue;
-					}
-					// Imprimir los detalles de cada descriptor
-					/*printf("%15llu %15llu %15llu %35s %35s\n", 
-							desc[j].starting_lba, 
-							desc[j].ending_lba, 
-							((desc[j].ending_lba - desc[j].starting_lba) * (unsigned long long)(512)), // Tamaño en bytes
-							get_gpt_partition_type(guid_to_str(&desc[j].partition_type_guid))->description, 
-							gpt_decode_partition_name(desc[j].partition_name));
-					*/
-					print_gpt_partition_table(&desc[j]);
-				}
-			}
-			printf("------------    ------------    ------------    ------------------------------   --------------------\n");
-		}else {
-			printf("El esquema de partición es MBR. Imprimiendo tabla de particiones MBR...\n");
-			print_mbr_partition_table(&boot_record);
-			
-		}
-	}
-	return 0;
-}
-
-
-int read_lba_sector(char * disk, unsigned long long lba, char buf[SECTOR_SIZE]) {
-
-	/* TODO leer un sector de 512 bytes del disco especificado en el buffer */
-
-	FILE *fp;
-	//ABRIR EL DISPOSITIVO EN MODO LECTURA
-	fp=fopen(disk, "r");
-
-	if(fp==NULL){
-		fprintf(stderr, "Error: No se pudo abrir el archivo o dispositivo %s\n", disk);
-        return 0; // Retornar error si el archivo no puede abrirse
-    }
-// Mover el puntero del archivo al sector solicitado (LBA)
-
-	if (fseek(fp, lba * SECTOR_SIZE, SEEK_SET) != 0){
-		fprintf(stderr, "Error: No se pudo posicionar en el sector %llu del dispositivo %s\n", lba, disk);
-        fclose(fp);
-        return 0; // Retornar error si el posicionamiento falla
-    }
-
-// Leer el sector y almacenarlo en el buffer	
-	if(fread(buf,1, SECTOR_SIZE,fp)!= SECTOR_SIZE){
-		fprintf(stderr, "Error: No se pudo leer el sector %llu del dispositivo %s\n", lba, disk);
-        fclose(fp);
-        return 0; // Retornar error si la lectura falla
-    }
-
-	fclose(fp);
-	return 1;  // Lectura exitosa
-
-
-}
-
-void ascii_dump(char * buf, size_t size) {
-	 // Iterar sobre los bytes del buffer y mostrar su representación ASCII
-	for (size_t i = 0; i < size; i++) {
-		if (buf[i] >= 0x20 && buf[i] < 0x7F) {
-			printf("%c", buf[i]); // Mostrar caracteres imprimibles
-		}else {
-			printf("."); // Sustituir caracteres no imprimibles con un punto
-		}
-	}
-}
-
-void hex_dump(char * buf, size_t size) {
-	int cols=0; //Contador de columnas
-
-	for (size_t i=0; i < size; i++) {
-		printf("%02x ", buf[i] & 0xff);//Imprimir cad abyte en formato hexadecimal
-		// Imprimir 16 bytes por línea, seguidos de su representación ASCII
-		if (++cols % 16 == 0) {
-			ascii_dump(&buf[cols - 16], 16);//Imprimir el ASCII de los ultimos 16 bytes
-			printf("\n");
-		}
-	}
+/**
+ * @file main.c
+ * @author 
+ *
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @brief Programa para listar particiones de discos con esquemas MBR/GPT.
+ * 
+ * Este programa accede directamente a dispositivos de bloque y analiza
+ * el primer sector para determinar el esquema de partición. Proporciona
+ * herramientas para visualizar los datos en formato hexadecimal y ASCII.
+ * 
+ * @copyright MIT License
+ */
+
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <getopt.h>
+#endif
+
+#include "mbr.h"
+#include "gpt.h"
+#include "listpart.h"
+#include "print.h"
+#include "disk.h"
+#include "pool.h"
+#include "uring.h"
+#include "dump.h"
+#include "json.h"
+#include "cache.h"
+#include "watch.h"
+#include "recover.h"
+#include "stats.h"
+
+/**
+ * @brief Muestra el contenido de un buffer en formato hexadecimal.
+ * 
+ * Esta función imprime los datos de un buffer en formato hexadecimal
+ * y su representación ASCII correspondiente.
+ * 
+ * @param out Flujo donde se imprime el volcado.
+ * @param buf Puntero al buffer que contiene los datos a imprimir.
+ * @param size Tamaño del buffer.
+ */
+void hex_dump(FILE *out, char *buf, size_t size);
+
+/**
+ * @struct scan_context
+ * @brief Datos compartidos por los trabajos de análisis.
+ *
+ * @var scan_context::devices
+ * Rutas de los dispositivos a analizar.
+ * @var scan_context::disks
+ * Dispositivos ya abiertos y leídos por adelantado (modo io_uring), o NULL
+ * si cada trabajo abre su propio dispositivo.
+ * @var scan_context::check_backup
+ * 1 para comparar siempre la tabla GPT primaria con la de respaldo.
+ * @var scan_context::probe_fs
+ * 1 para identificar el sistema de archivos de cada partición.
+ * @var scan_context::json
+ * 1 para escribir un registro NDJSON por dispositivo en lugar de las tablas.
+ * @var scan_context::cache_dir
+ * Directorio de la caché de resultados, o NULL si no está disponible.
+ * @var scan_context::cache_enabled
+ * 1 para buscar y guardar los resultados en la caché.
+ * @var scan_context::cache_invalidate
+ * 1 para descartar la entrada de cada dispositivo antes de analizarlo.
+ * @var scan_context::recover
+ * 1 para recorrer todo el dispositivo en busca de particiones perdidas.
+ * @var scan_context::direct
+ * 1 para leer los dispositivos con O_DIRECT (--direct).
+ * @var scan_context::dump
+ * 1 para volcar un rango de bytes en lugar de analizar la tabla de particiones.
+ * @var scan_context::dump_offset
+ * Desplazamiento en bytes del rango a volcar.
+ * @var scan_context::dump_length
+ * Longitud en bytes del rango a volcar.
+ */
+typedef struct {
+	char **devices;
+	disk_handle *disks;
+	int check_backup;
+	int probe_fs;
+	int json;
+	const char *cache_dir;
+	int cache_enabled;
+	int cache_invalidate;
+	int recover;
+	int direct;
+	int dump;
+	unsigned long long dump_offset;
+	unsigned long long dump_length;
+} scan_context;
+
+/**
+ * @def SCAN_PARTITIONS
+ * @brief Particiones que caben en el arreglo inicial del análisis.
+ *
+ * Los discos con más particiones se analizan de nuevo con un arreglo del
+ * tamaño exacto.
+ */
+#define SCAN_PARTITIONS 128
+
+/**
+ * @brief Analiza un disco usando la caché de resultados cuando es posible.
+ *
+ * No se guardan los resultados que dependen del final del disco, porque la
+ * validación de la caché no lo cubre: los de la comparación del respaldo
+ * GPT (-b) y los que se obtuvieron leyendo la tabla de respaldo porque la
+ * primaria era inválida. Con -f los sistemas de archivos se examinan
+ * siempre.
+ *
+ * @param disk Dispositivo abierto.
+ * @param flags Opciones de listpart_parse_disk().
+ * @param scan Opciones del análisis (directorio de la caché).
+ * @param result Resultado, inicializado con listpart_result_init().
+ */
+static void scan_parse(disk_handle *disk, int flags, const scan_context *scan, listpart_result *result) {
+	int cacheable = scan->cache_enabled && scan->cache_dir != NULL && !(flags & LISTPART_CHECK_BACKUP);
+
+	if (cacheable && cache_load(scan->cache_dir, disk, result)) {
+		if (flags & LISTPART_PROBE_FS) {
+			listpart_probe_filesystems(disk, result->partitions, result->count);
+		}
+		return;
+	}
+	listpart_parse_disk(disk, flags, result);
+	if (result->gpt_header_from_backup || result->gpt_backup_read) {
+		cacheable = 0;
+	}
+	if (cacheable && result->error == NULL && result->count == result->total) {
+		cache_store(scan->cache_dir, disk, result);
+	}
+}
+
+/**
+ * @brief Analiza un disco con un arreglo de particiones del tamaño necesario.
+ *
+ * Primero se usa `storage`, de SCAN_PARTITIONS elementos; si el disco tiene
+ * más particiones se repite el análisis con un arreglo reservado.
+ *
+ * @param disk Dispositivo abierto.
+ * @param scan Opciones del análisis.
+ * @param storage Arreglo inicial de SCAN_PARTITIONS particiones.
+ * @param result Resultado del análisis.
+ * @return Arreglo de las particiones: `storage` o uno que el llamador debe liberar.
+ */
+static listpart_partition *scan_result(disk_handle *disk, const scan_context *scan,
+		listpart_partition storage[SCAN_PARTITIONS], listpart_result *result) {
+	listpart_partition *parts = storage;
+	int flags = (scan->check_backup ? LISTPART_CHECK_BACKUP : 0) | (scan->probe_fs ? LISTPART_PROBE_FS : 0);
+
+	listpart_result_init(result, storage, SCAN_PARTITIONS);
+	scan_parse(disk, flags, scan, result);
+	if (result->total > result->count
+			&& (parts = (listpart_partition *)malloc(result->total * sizeof(listpart_partition))) != NULL) {
+		listpart_result_init(result, parts, result->total);
+		scan_parse(disk, flags, scan, result);
+	}
+	return parts != NULL ? parts : storage;
+}
+
+/**
+ * @brief Imprime la comparación de la tabla GPT primaria con la de respaldo (-b).
+ *
+ * El resultado de la biblioteca solo guarda la cantidad de diferencias; el
+ * informe campo por campo y descriptor por descriptor se obtiene cargando
+ * de nuevo ambas tablas.
+ *
+ * @return int Cantidad de diferencias (ver gpt_compare_tables()).
+ */
+static int scan_compare_gpt(FILE *out, disk_handle *disk) {
+	gpt_table primary, backup;
+	int diffs;
+
+	gpt_load_tables(disk, 1, &primary, &backup);
+	diffs = gpt_compare_tables(out, &primary, &backup);
+	gpt_free_table(&primary);
+	gpt_free_table(&backup);
+	return diffs;
+}
+
+/**
+ * @brief Analiza un dispositivo e imprime su esquema y tabla de particiones.
+ *
+ * El análisis es el de la biblioteca, el mismo del modo JSON; aquí solo se
+ * imprime el resultado.
+ * 
+ * @param out Flujo donde se escribe el resultado del análisis.
+ * @param disk Dispositivo abierto.
+ * @param scan Opciones del análisis.
+ * @return int 0 si el análisis terminó, 1 si ocurrió un error grave.
+ */
+static int scan_device(FILE *out, disk_handle *disk, const scan_context *scan) {
+	const char *path = disk->path;
+	listpart_partition storage[SCAN_PARTITIONS];
+	listpart_partition *parts;
+	listpart_result result;
+	int status = 0;
+
+	// 2.1 Leer el primer sector del disco especificado y analizarlo
+	parts = scan_result(disk, scan, storage, &result);
+	// 2.2 Si la lectura falla imprimir error y terminar.
+	if (!result.boot_record_read) {
+		fprintf(stderr, "Error: No se pudo leer el dispositivo %s\n", path);
+		return 0;//Salta al siguiente dispositivo
+	}
+
+	// Imprimir el contenido del primer sector en formato hexadecimal
+	fprintf(out, "Contenido del primer sector del disco:%s:\n", path);
+	hex_dump(out, (char*)&result.boot_record, sizeof(mbr));
+	//PRE: se pudo leer el primer sector del disco
+	//3.Imprimir la tabla de particiones MBR leido
+
+	// Paso 3.1Verificar si el MBR es válido
+	if (result.scheme == LISTPART_SCHEME_UNKNOWN) {
+		fprintf(stderr, "Advertencia: El sector de arranque del dispositivo %s no contiene una firma válida.\n", path);
+		fprintf(stderr, "Advertencia: Use -r para buscar particiones perdidas en %s.\n", path);
+		return 0; // Saltar al siguiente dispositivo
+	}
+	fprintf(out, "La firma del MBR es valida. Analizando el disco...\n");
+
+	// 4. Si el esquema de particiones es MBR: terminar
+	// 4.1 Determinar el esquema de partición (MBR o GPT)
+	if (result.scheme == LISTPART_SCHEME_GPT) {
+		fprintf(out, "El esquema de particion es GPT con mbr de proteccion. Procediendo a imprimir la tabla GPT...\n");
+		if (result.error != NULL) {
+			fprintf(stderr, "Error: %s (%s)\n", result.error, path);
+			status = 1;
+		} else {
+			if (result.gpt_header_from_backup) {
+				fprintf(stderr, "Advertencia: La cabecera GPT primaria del dispositivo %s es invalida\n", path);
+				fprintf(stderr, "Advertencia: Usando la cabecera GPT de respaldo del dispositivo %s\n", path);
+				fprintf(out, "La cabecera GPT primaria es invalida. Usando la cabecera de respaldo (LBA %llu)...\n",
+						result.gpt_header.my_lba);
+			}
+			print_listpart_gpt(out, &result);
+			if (scan->probe_fs) {
+				print_fs_table(out, result.partitions, result.count);
+			}
+			// Informar si el arreglo de descriptores coincide con su CRC32
+			if (result.gpt_entries_valid) {
+				fprintf(out, "CRC32 del arreglo de descriptores: valido\n");
+			} else {
+				fprintf(out, "CRC32 del arreglo de descriptores: INVALIDO\n");
+				fprintf(stderr, "Advertencia: El arreglo de descriptores GPT del dispositivo %s no coincide con su CRC32\n", path);
+			}
+			// Informar las diferencias entre la tabla primaria y la de respaldo
+			if (scan->check_backup && scan_compare_gpt(out, disk) > 0) {
+				fprintf(stderr, "Advertencia: Las tablas GPT primaria y de respaldo del dispositivo %s difieren\n", path);
+			}
+		}
+	} else {
+		fprintf(out, "El esquema de partición es MBR. Imprimiendo tabla de particiones MBR...\n");
+		print_listpart_mbr(out, &result);
+		if (scan->probe_fs) {
+			print_fs_table(out, result.partitions, result.count);
+		}
+	}
+	if (parts != storage) {
+		free(parts);
+	}
+	return status;
+}
+
+/**
+ * @brief Analiza un dispositivo con la biblioteca y escribe el resultado como campos JSON.
+ *
+ * @param w Escritor JSON, dentro del objeto del dispositivo.
+ * @param disk Dispositivo abierto.
+ * @param scan Opciones del análisis.
+ * @return int 0 si el análisis terminó, 1 si ocurrió un error grave.
+ */
+static int scan_device_json(json_writer *w, disk_handle *disk, const scan_context *scan) {
+	listpart_partition storage[SCAN_PARTITIONS];
+	listpart_result result;
+	listpart_partition *parts = scan_result(disk, scan, storage, &result);
+
+	json_listpart_result(w, &result);
+	if (result.error != NULL) {
+		fprintf(stderr, "Error: %s (%s)\n", result.error, disk->path);
+	}
+	if (parts != storage) {
+		free(parts);
+	}
+	// Como en el modo texto, solo los errores de GPT se consideran graves
+	return result.error != NULL && result.scheme == LISTPART_SCHEME_GPT;
+}
+
+/**
+ * @brief Escribe el registro NDJSON de un dispositivo.
+ *
+ * El registro se construye en el buffer del escritor y se escribe con una
+ * sola llamada. Si el dispositivo no se pudo abrir, el registro solo
+ * informa el error. Con --stats el registro incluye lo medido mientras se
+ * analizaba el dispositivo (`stats`, tomado con stats_snapshot() antes de
+ * abrirlo).
+ *
+ * @return int 0 si el análisis terminó, 1 si ocurrió un error grave.
+ */
+static int scan_record_json(FILE *out, disk_handle *disk, const char *path, const scan_context *scan,
+		stats_totals *stats) {
+	json_writer writer;
+	int status = 0;
+
+	json_init(&writer, out);
+	json_begin_object(&writer, NULL);
+	json_string(&writer, "device", path);
+	if (disk->fd < 0) {
+		json_string(&writer, "status", "error");
+		json_string(&writer, "error", "No se pudo abrir el dispositivo");
+	} else {
+		status = scan_device_json(&writer, disk, scan);
+	}
+	if (stats != NULL) {
+		stats_since(stats);
+		json_stats(&writer, "stats", stats);
+	}
+	json_end_object(&writer);
+	if (!json_end_record(&writer)) {
+		fprintf(stderr, "Error: No se pudo escribir el registro JSON del dispositivo %s\n", path);
+		status = 1;
+	}
+	return status;
+}
+
+/**
+ * @brief Trabajo del conjunto de hilos: analiza el dispositivo `index`.
+ */
+static int scan_job(int index, FILE *out, void *ctx) {
+	scan_context *scan = (scan_context *)ctx;
+	const char *path = scan->devices[index];
+	disk_handle local;
+	disk_handle *disk = &local; // Dispositivo abierto una sola vez por análisis
+	stats_totals measured;
+	stats_totals *stats = NULL; // Mediciones del dispositivo para su registro JSON
+
+	int json = scan->json && !scan->dump && !scan->recover; // El volcado y la búsqueda siempre son texto
+	if (json && stats_enabled()) {
+		stats_snapshot(&measured);
+		stats = &measured;
+	}
+	if (!json) {
+		fprintf(out, "\nAnalizando dispositivo: %s\n", path);
+	}
+	if (scan->disks != NULL) {
+		disk = &scan->disks[index];
+	} else {
+		disk_open_flags(disk, path, scan->direct ? DISK_OPEN_DIRECT : 0);
+	}
+	if (disk->fd < 0) {
+		fprintf(stderr, "Error: No se pudo abrir el dispositivo %s\n", path);
+		if (json) {
+			scan_record_json(out, disk, path, scan, stats);
+		}
+		return 0;//Salta al siguiente dispositivo
+	}
+	if (scan->cache_invalidate && scan->cache_dir != NULL && !cache_invalidate(scan->cache_dir, disk)) {
+		fprintf(stderr, "Advertencia: No se pudo descartar la entrada de la cache del dispositivo %s\n", path);
+	}
+	int status;
+	if (json) {
+		status = scan_record_json(out, disk, path, scan, stats);
+	} else if (scan->dump) {
+		fprintf(out, "Volcado de %s desde el byte %llu (%llu bytes):\n", path, scan->dump_offset, scan->dump_length);
+		status = dump_disk_range(out, disk, scan->dump_offset, scan->dump_length) ? 0 : 1;
+		if (status != 0) {
+			fprintf(stderr, "Error: No se pudo volcar el dispositivo %s\n", path);
+		}
+	} else if (scan->recover) {
+		status = recover_scan(out, disk) ? 0 : 1;
+		if (status != 0) {
+			fprintf(stderr, "Error: No se pudo recorrer el dispositivo %s\n", path);
+		}
+	} else {
+		status = scan_device(out, disk, scan);
+	}
+	disk_close(disk);
+	return status;
+}
+
+/**
+ * @brief Imprime la forma de uso del programa y termina con error.
+ */
+static void usage(const char *program) {
+	fprintf(stderr, "Uso: %s [-b] [-C] [-d INICIO[,LONGITUD]] [-f] [-J] [-j N] [-n] [-r] [-u] [--direct] [--stats] <dispositivo>...\n", program);
+	fprintf(stderr, "       %s -w|--watch [-b] [-f] [--direct] [dispositivo|imagen|directorio]...\n", program);
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Interpreta el argumento de -d: "INICIO[,LONGITUD]" en bytes.
+ *
+ * Ambos valores aceptan notación decimal, octal o hexadecimal (0x...). Si
+ * se omite la longitud, se vuelca un sector de 512 bytes.
+ *
+ * @return int 1 si el argumento es válido, 0 en caso contrario.
+ */
+static int parse_dump_range(const char *arg, scan_context *scan) {
+	char *end;
+
+	scan->dump_offset = strtoull(arg, &end, 0);
+	scan->dump_length = SECTOR_SIZE;
+	if (end == arg) {
+		return 0;
+	}
+	if (*end == ',') {
+		arg = end + 1;
+		scan->dump_length = strtoull(arg, &end, 0);
+		if (end == arg) {
+			return 0;
+		}
+	}
+	scan->dump = 1;
+	return *end == '\0';
+}
+
+int main(int argc, char *argv[]) {
+	int jobs = 1; // Cantidad de dispositivos que se analizan a la vez
+	int use_uring = 0; // Leer los primeros sectores de cada lote con io_uring
+	scan_context scan = {0};
+	char cache_path[CACHE_PATH_LEN];
+	int use_cache = 1; // Usar la caché de resultados
+	int watch = 0; // Vigilar los dispositivos en lugar de analizarlos una vez
+	int opt;
+	static const struct option long_options[] = {
+		{ "direct", no_argument, NULL, 'D' },
+		{ "stats", no_argument, NULL, 'S' },
+		{ "watch", no_argument, NULL, 'w' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	// 1. Validar los argumentos de línea de comandos
+	while ((opt = getopt_long(argc, argv, "bCd:fJj:nruw", long_options, NULL)) != -1) {
+		switch (opt) {
+		case 'd':
+			if (!parse_dump_range(optarg, &scan)) {
+				usage(argv[0]);
+			}
+			break;
+		case 'u':
+			use_uring = 1;
+			break;
+		case 'b':
+			scan.check_backup = 1;
+			break;
+		case 'C':
+			scan.cache_invalidate = 1;
+			break;
+		case 'n':
+			use_cache = 0;
+			break;
+		case 'w':
+			watch = 1;
+			break;
+		case 'r':
+			scan.recover = 1;
+			break;
+		case 'f':
+			scan.probe_fs = 1;
+			break;
+		case 'J':
+			scan.json = 1;
+			break;
+		case 'D':
+			scan.direct = 1;
+			break;
+		case 'S':
+			stats_enable();
+			break;
+		case 'j':
+			jobs = atoi(optarg);
+			if (jobs >= 1) {
+				break;
+			}
+			/* fall through */
+		default:
+			usage(argv[0]);
+		}
+	}
+	// Con -w no hace falta indicar dispositivos: se vigilan todos los discos
+	if (watch) {
+		// El modo de vigilancia solo admite -b, -f y --direct
+		if (scan.json || !use_cache || scan.recover || scan.dump || use_uring || jobs != 1
+				|| scan.cache_invalidate || stats_enabled()) {
+			fprintf(stderr, "Error: -w no admite -C, -d, -j, -J, -n, -r, -u ni --stats\n");
+			usage(argv[0]);
+		}
+		int flags = (scan.check_backup ? LISTPART_CHECK_BACKUP : 0) | (scan.probe_fs ? LISTPART_PROBE_FS : 0)
+			| (scan.direct ? LISTPART_DIRECT : 0);
+		return watch_run(&argv[optind], argc - optind, flags, stdout) ? 0 : EXIT_FAILURE;
+	}
+    if (optind >= argc) {
+        usage(argv[0]);
+    }
+	// La caché guarda el resultado del análisis, que usan tanto el modo texto
+	// como el JSON; el volcado (-d) y la búsqueda (-r) leen el disco directamente
+	scan.cache_enabled = use_cache && !scan.dump && !scan.recover;
+	if ((scan.cache_enabled || scan.cache_invalidate) && cache_dir(cache_path)) {
+		scan.cache_dir = cache_path;
+	}
+
+	// Iterar sobre los dispositivos pasados como argumentos; con -j N se
+	// analizan N a la vez y los resultados se imprimen en el orden de argv.
+	// Con -u los dispositivos se abren por lotes y sus primeros sectores se
+	// leen con una sola tanda de io_uring antes de analizarlos.
+	int count = argc - optind;
+	int batch = use_uring ? URING_QUEUE_DEPTH : count;
+	int failed = 0;
+	if (use_uring) {
+		scan.disks = (disk_handle *)calloc(batch, sizeof(disk_handle));
+		if (scan.disks == NULL) {
+			batch = count;
+		}
+	}
+	for (int first = 0; first < count; first += batch) {
+		int n = count - first < batch ? count - first : batch;
+		scan.devices = &argv[optind + first];
+		if (scan.disks != NULL) {
+			for (int i = 0; i < n; i++) {
+				disk_open_flags(&scan.disks[i], scan.devices[i], scan.direct ? DISK_OPEN_DIRECT : 0);
+			}
+			disk_prefetch_batch(scan.disks, n, 0, DISK_PROBE_SECTORS);
+		}
+		failed += pool_run(n, jobs, scan_job, &scan, stdout);
+	}
+	free(scan.disks);
+	// El resumen va a stderr para no mezclarse con los registros JSON
+	if (stats_enabled()) {
+		fflush(stdout);
+		stats_report(stderr);
+	}
+	return failed == 0 ? 0 : EXIT_FAILURE;
+}
+
+void hex_dump(FILE *out, char * buf, size_t size) {
+	// Formatear todas las filas (16 bytes en hexadecimal seguidos de su
+	// representación ASCII) y escribirlas con una sola escritura
+	if (!dump_buffer(out, buf, size, 0, 0)) {
+		fprintf(stderr, "Error: No se pudo escribir el volcado hexadecimal\n");
+	}
 }
\ No newline at end of file
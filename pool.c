@@ -0,0 +1,131 @@
+/**
+ * @file pool.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "pool.h"
+
+/**
+ * @struct pool_result
+ * @brief Resultado de un trabajo terminado.
+ */
+typedef struct {
+	char *buf;    ///< Salida formateada del trabajo.
+	size_t len;   ///< Longitud de la salida.
+	int status;   ///< Valor retornado por el trabajo.
+	int done;     ///< 1 cuando el trabajo terminó.
+} pool_result;
+
+/**
+ * @struct pool_state
+ * @brief Estado compartido entre los hilos trabajadores y el hilo que imprime.
+ */
+typedef struct {
+	int count;              ///< Cantidad de trabajos.
+	int next;               ///< Siguiente trabajo sin asignar.
+	pool_job job;           ///< Función de trabajo.
+	void *ctx;              ///< Contexto de los trabajos.
+	pool_result *results;   ///< Resultados indexados por trabajo.
+	pthread_mutex_t lock;
+	pthread_cond_t ready;   ///< Señala que terminó algún trabajo.
+} pool_state;
+
+static void *pool_worker(void *arg) {
+	pool_state *state = (pool_state *)arg;
+
+	for (;;) {
+		pthread_mutex_lock(&state->lock);
+		int index = state->next++;
+		pthread_mutex_unlock(&state->lock);
+		if (index >= state->count) {
+			return NULL;
+		}
+
+		pool_result result = {0};
+		FILE *out = open_memstream(&result.buf, &result.len);
+		if (out == NULL) {
+			result.status = -1;
+		} else {
+			result.status = state->job(index, out, state->ctx);
+			fclose(out);
+		}
+
+		pthread_mutex_lock(&state->lock);
+		result.done = 1;
+		state->results[index] = result;
+		pthread_cond_broadcast(&state->ready);
+		pthread_mutex_unlock(&state->lock);
+	}
+}
+
+int pool_run(int count, int jobs, pool_job job, void *ctx, FILE *out) {
+	int failed = 0;
+
+	if (jobs > count) {
+		jobs = count;
+	}
+	if (jobs <= 1) {
+		for (int i = 0; i < count; i++) {
+			if (job(i, out, ctx) != 0) {
+				failed++;
+			}
+		}
+		return failed;
+	}
+
+	pool_state state = {0};
+	state.count = count;
+	state.job = job;
+	state.ctx = ctx;
+	state.results = (pool_result *)calloc(count, sizeof(pool_result));
+	pthread_t *threads = (pthread_t *)calloc(jobs, sizeof(pthread_t));
+	if (state.results == NULL || threads == NULL) {
+		free(state.results);
+		free(threads);
+		return pool_run(count, 1, job, ctx, out);
+	}
+	pthread_mutex_init(&state.lock, NULL);
+	pthread_cond_init(&state.ready, NULL);
+
+	int started = 0;
+	for (; started < jobs; started++) {
+		if (pthread_create(&threads[started], NULL, pool_worker, &state) != 0) {
+			break;
+		}
+	}
+	if (started == 0) {
+		// Sin hilos disponibles: trabajar en el hilo actual
+		pool_worker(&state);
+	}
+
+	// Imprimir los resultados en orden, a medida que terminan
+	for (int i = 0; i < count; i++) {
+		pthread_mutex_lock(&state.lock);
+		while (!state.results[i].done) {
+			pthread_cond_wait(&state.ready, &state.lock);
+		}
+		pthread_mutex_unlock(&state.lock);
+
+		pool_result *result = &state.results[i];
+		if (result->buf != NULL) {
+			fwrite(result->buf, 1, result->len, out);
+			free(result->buf);
+		}
+		if (result->status != 0) {
+			failed++;
+		}
+	}
+
+	for (int t = 0; t < started; t++) {
+		pthread_join(threads[t], NULL);
+	}
+	pthread_cond_destroy(&state.ready);
+	pthread_mutex_destroy(&state.lock);
+	free(threads);
+	free(state.results);
+	return failed;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file pool.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Conjunto de hilos trabajadores para analizar varios dispositivos a la vez.
+ *
+ * Cada trabajo escribe su resultado en un buffer propio; los buffers se
+ * imprimen en el orden de los trabajos para que la salida sea determinista
+ * sin importar el orden en que terminan las lecturas.
+ * @copyright MIT License
+ */
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdio.h>
+
+/**
+ * @brief Función que realiza un trabajo.
+ *
+ * @param index Índice del trabajo (0 .. count-1).
+ * @param out Flujo donde el trabajo debe escribir su resultado.
+ * @param ctx Contexto compartido por todos los trabajos.
+ * @return int 0 si el trabajo terminó bien, distinto de 0 si falló.
+ */
+typedef int (*pool_job)(int index, FILE *out, void *ctx);
+
+/**
+ * @brief Ejecuta `count` trabajos usando hasta `jobs` hilos.
+ *
+ * Los resultados se escriben en `out` en orden de índice, a medida que
+ * están disponibles. Con `jobs <= 1` los trabajos se ejecutan en el hilo
+ * actual escribiendo directamente en `out`.
+ *
+ * @param count Cantidad de trabajos.
+ * @param jobs Cantidad máxima de hilos trabajadores.
+ * @param job Función que realiza cada trabajo.
+ * @param ctx Contexto que se pasa a cada trabajo.
+ * @param out Flujo donde se escriben los resultados.
+ * @return int Cantidad de trabajos que fallaron.
+ */
+int pool_run(int count, int jobs, pool_job job, void *ctx, FILE *out);
+
+#endif
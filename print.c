@@ -0,0 +1,406 @@
+/**
+ * @file print.c
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <stdio.h>
+#include "print.h"
+#include "stats.h"
+
+/**
+ * @brief Imprime una fila de la tabla de particiones MBR.
+ *
+ * @param out Flujo donde se imprime la fila.
+ * @param boot 1 si la partición está marcada como activa.
+ * @param chs_start Dirección CHS de inicio del descriptor.
+ * @param chs_end Dirección CHS de fin del descriptor.
+ * @param type_description Descripción del tipo de partición.
+ * @param start_lba LBA absoluto de inicio (en las particiones lógicas difiere
+ *                  del campo relativo `start_lba` del descriptor).
+ * @param sectors Tamaño de la partición en sectores.
+ * @param sector_size Tamaño de sector lógico del disco en bytes.
+ * @param allocated Bytes con datos de la partición, o NULL para omitir la columna.
+ */
+static void print_mbr_row(FILE *out, int boot, const unsigned char chs_start[3], const unsigned char chs_end[3],
+        const char *type_description, unsigned long long start_lba, unsigned long long sectors,
+        unsigned int sector_size, const unsigned long long *allocated) {
+		//Obtener stamaño y convertir a MB 1 MB= sectores*tamaño de sector/(1024X1024) BYTES
+	 	 unsigned long size_in_MB = (unsigned long)(sectors * sector_size / (1024 * 1024));
+		 //obtener lba final a partir del lba de inicio y el tamaño, lba fin= lbaInicio+tamaño(en sectores)-1
+		 unsigned long long lba_fin= start_lba+ sectors-1;
+
+        // Determinar si la partición es arrancable.
+		const char *boot_flag;
+		if (boot) {
+   			boot_flag = " Activa ";
+		} else {
+   			boot_flag = " Inactiva ";
+		}
+		// Convertir CHS inicio y fin a formato legible.
+        char chs_start_str[16], chs_end_str[16];
+        snprintf(chs_start_str, sizeof(chs_start_str), "%02X/%02X/%02X",
+                 chs_start[0], chs_start[1], chs_start[2]);
+        snprintf(chs_end_str, sizeof(chs_end_str), "%02X/%02X/%02X",
+                 chs_end[0], chs_end[1], chs_end[2]);
+
+
+
+        // Imprimir detalles de la partición.
+      fprintf(out, "| %s | %14s | %13s | %25s | %10llu | %10llu | %9lu MB|",
+               boot_flag,
+               chs_start_str,
+               chs_end_str,
+               type_description,
+               start_lba,
+			   lba_fin,
+               size_in_MB);
+		// Bytes asignados (sin huecos) y su proporción respecto del tamaño
+		if (allocated != NULL) {
+			unsigned long long bytes = sectors * sector_size;
+			fprintf(out, " %9llu MB (%3u%%) |", *allocated / (1024 * 1024),
+					bytes > 0 ? (unsigned int)(*allocated * 100 / bytes) : 0);
+		}
+		fprintf(out, "\n");
+}
+
+/**
+ * @brief Imprime una fila de la tabla MBR a partir del descriptor leído del disco.
+ */
+static void print_mbr_partition_row(FILE *out, const mbr_partition_descriptor *part, unsigned long long start_lba,
+        unsigned int sector_size, const unsigned long long *allocated) {
+    // Obtener una descripción del tipo de partición.
+    const char *type_description = mbr_type_lookup(part->partition_type)->name;
+
+    print_mbr_row(out, part->boot_flag == 0x80, part->chs_start, part->chs_end, type_description, start_lba,
+            part->size, sector_size, allocated);
+}
+
+/**
+ * @brief Imprime una fila de la tabla MBR a partir de una partición de la biblioteca.
+ */
+static void print_listpart_mbr_row(FILE *out, const listpart_result *result, const listpart_partition *part) {
+    print_mbr_row(out, part->boot, part->chs_start, part->chs_end, part->type_name, part->start_lba,
+            part->sectors, result->sector_size, result->allocated_known ? &part->allocated_bytes : NULL);
+}
+
+/**
+ * @brief Imprime el encabezado de una tabla de particiones MBR.
+ *
+ * @param out Flujo donde se imprime el encabezado.
+ * @param allocated 1 si la tabla incluye la columna de bytes asignados.
+ */
+static void print_mbr_table_header(FILE *out, int allocated) {
+    const char *extra = allocated ? "----------------------" : "";
+    fprintf(out, "-----------------------------------------------------------------------------------------------------------------------%s\n", extra);
+    fprintf(out, "|    Boot    |   CHS INICIO   |    CHS FIN    |           Tipo           |  Inicio LBA  |    Fin LBA    | Tamano (MB) |%s\n",
+            allocated ? "       Asignado      |" : "");
+    fprintf(out, "------------------------------------------------------------------------------------------------------------------------%s\n", extra);
+}
+
+void print_mbr_partition_table(FILE *out, mbr *boot_record, unsigned int sector_size,
+        const unsigned long long *allocated) {
+    if (!boot_record) {
+        fprintf(out, "Error: El puntero al MBR es nulo.\n");
+        return;
+    }
+
+    unsigned long long start = stats_begin();
+    fprintf(out, "Tabla de particiones MBR:\n");
+    print_mbr_table_header(out, allocated != NULL);
+
+    for (int i = 0; i < 4; i++) {
+        mbr_partition_descriptor *part = &boot_record->partition_table[i];
+
+        // Ignorar entradas no usadas.
+        if (part->partition_type == MBR_TYPE_UNUSED) {
+            continue;
+        }
+        print_mbr_partition_row(out, part, part->start_lba, sector_size, allocated != NULL ? &allocated[i] : NULL);
+    }
+    fprintf(out, "-----------------------------------------------------------------------------------------------------------------------%s\n",
+            allocated != NULL ? "----------------------" : "");
+    stats_end(STATS_PRINT, start, 0);
+}
+
+void print_mbr_logical_partitions(FILE *out, const mbr_logical_partition *parts, int count,
+        unsigned int sector_size, const unsigned long long *allocated) {
+    unsigned long long start = stats_begin();
+    fprintf(out, "Particiones logicas (cadena EBR):\n");
+    print_mbr_table_header(out, allocated != NULL);
+    for (int i = 0; i < count; i++) {
+        print_mbr_partition_row(out, &parts[i].entry, parts[i].start_lba, sector_size,
+                allocated != NULL ? &allocated[i] : NULL);
+    }
+    fprintf(out, "-----------------------------------------------------------------------------------------------------------------------%s\n",
+            allocated != NULL ? "----------------------" : "");
+    stats_end(STATS_PRINT, start, 0);
+}
+
+void print_listpart_mbr(FILE *out, const listpart_result *result) {
+    const char *extra = result->allocated_known ? "----------------------" : "";
+    unsigned long long start = stats_begin();
+
+    fprintf(out, "Tabla de particiones MBR:\n");
+    print_mbr_table_header(out, result->allocated_known);
+    for (unsigned int i = 0; i < result->count; i++) {
+        if (!result->partitions[i].logical) {
+            print_listpart_mbr_row(out, result, &result->partitions[i]);
+        }
+    }
+    fprintf(out, "-----------------------------------------------------------------------------------------------------------------------%s\n", extra);
+
+    // Una tabla por partición extendida, con las lógicas cuyo EBR está dentro de ella
+    for (unsigned int i = 0; i < result->count; i++) {
+        const listpart_partition *ext = &result->partitions[i];
+        if (ext->logical || !ext->extended) {
+            continue;
+        }
+        fprintf(out, "Particiones logicas (cadena EBR):\n");
+        print_mbr_table_header(out, result->allocated_known);
+        for (unsigned int j = 0; j < result->count; j++) {
+            const listpart_partition *part = &result->partitions[j];
+            if (part->logical && part->ebr_lba >= ext->start_lba && part->ebr_lba <= ext->end_lba) {
+                print_listpart_mbr_row(out, result, part);
+            }
+        }
+        fprintf(out, "-----------------------------------------------------------------------------------------------------------------------%s\n", extra);
+    }
+    stats_end(STATS_PRINT, start, 0);
+}
+
+// Imprime la información de las particiones en formato tabular
+void print_gpt_header(FILE *out, gpt_header * hdr, unsigned int sector_size){
+	unsigned long long start = stats_begin();
+	fprintf(out, "GPT Header\n");
+	fprintf(out, "Revision: 0x%x\n", hdr->revision);
+	fprintf(out, "Header CRC32: 0x%08x (%s)\n", hdr->header_crc32,
+			gpt_header_crc_valid(hdr) ? "valido" : "INVALIDO");
+	fprintf(out, "First usable lba: %llu\n", hdr->first_usable_lba);
+	fprintf(out, "Last usable lba: %llu\n", hdr->last_usable_lba);
+	char guid_str[GUID_STR_LEN];
+	fprintf(out, "Disk GUID: %s\n", guid_to_str(&hdr->disk_guid, guid_str));
+	fprintf(out, "Partition entry lba: %llu\n", hdr->partition_entry_lba);
+	fprintf(out, "Number of partition entries: %u\n", hdr->num_partition_entries);
+	fprintf(out, "Size of partition entry: %u\n", hdr->size_partition_entry);
+	// Sectores que ocupa el arreglo; no depende de que un descriptor quepa en un sector
+	unsigned long long array_bytes = (unsigned long long)hdr->num_partition_entries * hdr->size_partition_entry;
+	fprintf(out, "Total of a partition descriptor: %llu\n", (array_bytes + sector_size - 1) / sector_size);
+	fprintf(out, "Size of a partition descriptor: %u\n", hdr->size_partition_entry);
+	fprintf(out, "Partition entry array CRC32: 0x%08x\n", hdr->partition_entry_array_crc32);
+	stats_end(STATS_PRINT, start, 0);
+}
+
+/**
+ * @brief Imprime una fila de la tabla de particiones GPT.
+ *
+ * @param allocated Bytes con datos de la partición, o NULL para omitir la columna.
+ */
+static void print_gpt_row(FILE *out, unsigned long long starting_lba, unsigned long long ending_lba,
+		const char *type_description, const char *name, unsigned int sector_size,
+		const unsigned long long *allocated) {
+	// El LBA final es inclusivo
+	unsigned long long bytes = (ending_lba - starting_lba + 1) * (unsigned long long)sector_size;
+	fprintf(out, "%15llu %15llu %15llu %35s %35s", 
+							starting_lba, 
+							ending_lba, 
+							bytes, // Tamaño en bytes
+							type_description, 
+							name);
+	// Bytes asignados (sin huecos) y su proporción respecto del tamaño
+	if (allocated != NULL) {
+		fprintf(out, "    %9llu MB (%3u%%)", *allocated / (1024 * 1024),
+				bytes > 0 ? (unsigned int)(*allocated * 100 / bytes) : 0);
+	}
+	fprintf(out, "\n");
+}
+
+void print_gpt_partition_table(FILE *out, gpt_partition_descriptor *partition, unsigned int sector_size) {
+	char name[GPT_NAME_LEN];
+	unsigned long long start = stats_begin();
+	print_gpt_row(out, partition->starting_lba, partition->ending_lba,
+			gpt_partition_type_by_guid(&partition->partition_type_guid)->description,
+			gpt_decode_partition_name(partition->partition_name, name), sector_size, NULL);
+	stats_end(STATS_PRINT, start, 0);
+}
+
+void print_listpart_gpt(FILE *out, const listpart_result *result) {
+	mbr boot_record = result->boot_record;
+	gpt_header hdr = result->gpt_header;
+
+	//Imprime la tabla de mbr de protección
+	print_gpt_protective_mbr_table(out, &boot_record, result->sector_size);
+	// En el PTHDR se encuentra la cantidad de descriptores de la tabla
+	print_gpt_header(out, &hdr, result->sector_size);
+	unsigned long long start = stats_begin();
+	// Con la columna de bytes asignados, si el disco informa sus huecos
+	const char *extra = result->allocated_known ? "   --------------------" : "";
+	fprintf(out, "\nStart LBA       End LBA         Size            Type                            Partition Name%s\n",
+			result->allocated_known ? "               Asignado" : "");
+	fprintf(out, "------------    ------------    ------------    ------------------------------   --------------------%s\n", extra);
+	for (unsigned int i = 0; i < result->count; i++) {
+		const listpart_partition *part = &result->partitions[i];
+		print_gpt_row(out, part->start_lba, part->end_lba, part->type_name, part->name, result->sector_size,
+				result->allocated_known ? &part->allocated_bytes : NULL);
+	}
+	fprintf(out, "------------    ------------    ------------    ------------------------------   --------------------%s\n", extra);
+	stats_end(STATS_PRINT, start, 0);
+}
+
+void print_fs_table(FILE *out, const listpart_partition *parts, unsigned int count) {
+	unsigned long long start = stats_begin();
+	fprintf(out, "Sistemas de archivos:\n");
+	fprintf(out, "----------------------------------------------------------------------------------------------------------------------------------------\n");
+	fprintf(out, "| Particion |  Inicio LBA  |              Tipo              | Sist. archivos |     Etiqueta     |                  UUID                  |\n");
+	fprintf(out, "----------------------------------------------------------------------------------------------------------------------------------------\n");
+	for (unsigned int i = 0; i < count; i++) {
+		const listpart_partition *part = &parts[i];
+		if (part->extended) {
+			continue;
+		}
+		fprintf(out, "| %9u | %12llu | %30.30s | %14s | %16.16s | %38s |\n",
+				part->number,
+				part->start_lba,
+				part->type_name,
+				part->fs.type != NULL ? part->fs.type : "-",
+				part->fs.label,
+				part->fs.uuid);
+	}
+	fprintf(out, "----------------------------------------------------------------------------------------------------------------------------------------\n");
+	stats_end(STATS_PRINT, start, 0);
+}
+
+void json_gpt_header(json_writer *w, const char *key, const gpt_header *hdr) {
+	char guid_str[GUID_STR_LEN];
+
+	json_begin_object(w, key);
+	json_uint(w, "revision", hdr->revision);
+	json_uint(w, "header_size", hdr->header_size);
+	json_uint(w, "header_crc32", hdr->header_crc32);
+	json_bool(w, "header_crc32_valid", gpt_header_crc_valid(hdr));
+	json_uint(w, "my_lba", hdr->my_lba);
+	json_uint(w, "alternate_lba", hdr->alternate_lba);
+	json_uint(w, "first_usable_lba", hdr->first_usable_lba);
+	json_uint(w, "last_usable_lba", hdr->last_usable_lba);
+	json_string(w, "disk_guid", guid_to_str(&hdr->disk_guid, guid_str));
+	json_uint(w, "partition_entry_lba", hdr->partition_entry_lba);
+	json_uint(w, "num_partition_entries", hdr->num_partition_entries);
+	json_uint(w, "size_partition_entry", hdr->size_partition_entry);
+	json_uint(w, "partition_entry_array_crc32", hdr->partition_entry_array_crc32);
+	json_end_object(w);
+}
+
+void print_gpt_protective_mbr_table(FILE *out, mbr *boot_record, unsigned int sector_size){
+	fprintf(out, "---------------------------------------------------------------------------------------------------------------------\n");
+	fprintf(out, "					GPT Protective MBR								 										\n");
+    fprintf(out, "---------------------------------------------------------------------------------------------------------------------\n");
+    print_mbr_partition_table(out, boot_record, sector_size, NULL);
+}
+
+void json_listpart_partition(json_writer *w, const listpart_result *result, const listpart_partition *part) {
+	listpart_scheme scheme = result->scheme;
+	char guid_str[GUID_STR_LEN];
+
+	json_begin_object(w, NULL);
+	json_uint(w, "index", part->number);
+	if (scheme == LISTPART_SCHEME_MBR) {
+		// "type" es la descripción en ambos esquemas; el código va aparte, como el GUID en GPT
+		char code[8];
+		snprintf(code, sizeof(code), "0x%02x", part->mbr_type);
+		json_bool(w, "boot", part->boot);
+		json_string(w, "mbr_type", code);
+		json_string(w, "type", part->type_name);
+		json_bool(w, "extended", part->extended);
+	}
+	json_uint(w, "start_lba", part->start_lba);
+	json_uint(w, "end_lba", part->end_lba);
+	json_uint(w, "sectors", part->sectors);
+	json_uint(w, "size_bytes", part->size_bytes);
+	if (result->allocated_known) {
+		json_uint(w, "allocated_bytes", part->allocated_bytes);
+	}
+	if (scheme == LISTPART_SCHEME_GPT) {
+		json_string(w, "type_guid", guid_to_str(&part->type_guid, guid_str));
+		json_string(w, "type", part->type_name);
+		json_string(w, "type_os", part->type_os);
+		json_string(w, "unique_guid", guid_to_str(&part->unique_guid, guid_str));
+		json_uint(w, "attributes", part->attributes);
+		json_string(w, "name", part->name);
+	}
+	if (part->fs.type != NULL) {
+		json_begin_object(w, "filesystem");
+		json_string(w, "type", part->fs.type);
+		json_string(w, "label", part->fs.label);
+		json_string(w, "uuid", part->fs.uuid);
+		json_end_object(w);
+	}
+	json_end_object(w);
+}
+
+/**
+ * @brief Escribe un arreglo con las particiones MBR primarias o las lógicas.
+ */
+static void json_mbr_partitions(json_writer *w, const char *key, const listpart_result *result, int logical) {
+	json_begin_array(w, key);
+	for (unsigned int i = 0; i < result->count; i++) {
+		if (result->partitions[i].logical == logical) {
+			json_listpart_partition(w, result, &result->partitions[i]);
+		}
+	}
+	json_end_array(w);
+}
+
+void json_listpart_result(json_writer *w, const listpart_result *result) {
+	unsigned long long start = stats_begin();
+	json_uint(w, "sector_size", result->sector_size);
+	json_uint(w, "physical_sector_size", result->physical_sector_size);
+	json_uint(w, "size_bytes", result->size_bytes);
+	if (result->boot_record_read) {
+		json_bool(w, "mbr_signature_valid", result->boot_record.signature == MBR_SIGNATURE);
+		json_string(w, "scheme", listpart_scheme_name(result->scheme));
+	}
+	if (result->error == NULL && result->scheme == LISTPART_SCHEME_GPT) {
+		json_begin_object(w, "gpt");
+		json_bool(w, "primary_header_valid", result->gpt_primary_header_valid);
+		json_string(w, "header_source", result->gpt_header_from_backup ? "backup" : "primary");
+		json_gpt_header(w, "header", &result->gpt_header);
+		json_bool(w, "entries_crc32_valid", result->gpt_entries_valid);
+		if (result->gpt_backup_read) {
+			json_begin_object(w, "backup");
+			json_bool(w, "header_valid", result->gpt_backup_header_valid);
+			json_bool(w, "entries_crc32_valid", result->gpt_backup_entries_valid);
+			if (result->gpt_differences >= 0) {
+				json_uint(w, "differences", (unsigned long long)result->gpt_differences);
+			}
+			json_end_object(w);
+		}
+		json_end_object(w);
+
+		json_begin_array(w, "partitions");
+		for (unsigned int i = 0; i < result->count; i++) {
+			json_listpart_partition(w, result, &result->partitions[i]);
+		}
+		json_end_array(w);
+	} else if (result->scheme == LISTPART_SCHEME_MBR) {
+		json_mbr_partitions(w, "partitions", result, 0);
+		json_mbr_partitions(w, "logical_partitions", result, 1);
+	}
+	json_string(w, "status", result->error == NULL ? "ok" : "error");
+	if (result->error != NULL) {
+		json_string(w, "error", result->error);
+	}
+	stats_end(STATS_PRINT, start, 0);
+}
+
+void json_stats(json_writer *w, const char *key, const stats_totals *totals) {
+	json_begin_object(w, key);
+	for (int p = 0; p < STATS_PHASES; p++) {
+		json_begin_object(w, stats_phase_name((stats_phase)p));
+		json_uint(w, "count", totals->count[p]);
+		json_uint(w, "total_ns", totals->total_ns[p]);
+		json_end_object(w);
+	}
+	json_uint(w, "bytes_read", totals->bytes);
+	json_end_object(w);
+}
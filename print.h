@@ -0,0 +1,140 @@
+/**
+ * @file print.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Presentación de las tablas MBR y GPT en texto y en JSON.
+ *
+ * Esta capa solo formatea estructuras ya leídas; el análisis de los discos
+ * está en la biblioteca (listpart.h, mbr.c, gpt.c), que no imprime
+ * resultados.
+ * @copyright MIT License
+ */
+#ifndef PRINT_H
+#define PRINT_H
+
+#include <stdio.h>
+#include "mbr.h"
+#include "gpt.h"
+#include "json.h"
+#include "listpart.h"
+#include "stats.h"
+
+/**
+ * @brief Imprime la tabla de particiones de un MBR.
+ * 
+ * Esta función asume que el MBR ya ha sido validado como un MBR tradicional.
+ * Recorre cada entrada en la tabla de particiones, imprimiendo sus detalles.
+ * 
+ * @param out Flujo donde se imprime la tabla.
+ * @param boot_record Puntero a la estructura MBR que contiene la tabla de particiones.
+ * @param sector_size Tamaño de sector lógico del disco, usado para calcular los tamaños.
+ * @param allocated Bytes con datos de cada una de las cuatro entradas (ver
+ *                  disk_allocated()), que se muestran junto al tamaño, o NULL
+ *                  si el disco no informa sus huecos.
+ */
+void print_mbr_partition_table(FILE *out, mbr *boot_record, unsigned int sector_size,
+        const unsigned long long *allocated);
+
+/**
+ * @brief Imprime las particiones lógicas de una partición extendida.
+ * 
+ * @param out Flujo donde se imprime la tabla.
+ * @param parts Particiones obtenidas con mbr_read_logical_partitions().
+ * @param count Cantidad de particiones.
+ * @param sector_size Tamaño de sector lógico del disco, usado para calcular los tamaños.
+ * @param allocated Bytes con datos de cada partición, o NULL para omitir la columna.
+ */
+void print_mbr_logical_partitions(FILE *out, const mbr_logical_partition *parts, int count,
+        unsigned int sector_size, const unsigned long long *allocated);
+
+/**
+ * @brief Imprime las particiones MBR encontradas por la biblioteca: la tabla
+ *        de las primarias y una tabla de lógicas por cada partición extendida.
+ *
+ * Si el disco informa sus huecos (`allocated_known`), las tablas incluyen
+ * la columna de bytes asignados.
+ *
+ * @param out Flujo donde se imprimen las tablas.
+ * @param result Resultado de listpart_parse_disk() con esquema MBR.
+ */
+void print_listpart_mbr(FILE *out, const listpart_result *result);
+
+/**
+ * @brief imprime la tabla de particiones del mbr de proteccion
+ * @param out flujo donde se imprime la tabla
+ * @param boot_record mbr de proteccion encontrado
+ * @param sector_size tamaño de sector logico del disco
+ */
+void print_gpt_protective_mbr_table(FILE *out, mbr *boot_record, unsigned int sector_size);
+
+/**
+ * @brief imprime la tabla de particiones de gpt
+ * @param out flujo donde se imprime la fila
+ * @param partition variable que describe los elementos importantes del descriptor de particiones de gpt
+ * @param sector_size tamaño de sector logico del disco
+ */
+void print_gpt_partition_table(FILE *out, gpt_partition_descriptor *partition, unsigned int sector_size);
+/**
+ * @brief Imprime el MBR de protección, la cabecera GPT usada y la tabla de
+ *        particiones encontradas por la biblioteca.
+ *
+ * Como en print_listpart_mbr(), la tabla incluye la columna de bytes
+ * asignados si el disco informa sus huecos.
+ *
+ * @param out Flujo donde se imprimen las tablas.
+ * @param result Resultado de listpart_parse_disk() con esquema GPT y sin error.
+ */
+void print_listpart_gpt(FILE *out, const listpart_result *result);
+
+/**
+ * @brief imprime la cabecera del gpt
+ * @param out flujo donde se imprime la cabecera
+ * @param hdr es la cabecera
+ * @param sector_size tamaño de sector logico del disco
+ */
+void print_gpt_header(FILE *out, gpt_header * hdr, unsigned int sector_size);
+/**
+ * @brief Imprime el sistema de archivos, la etiqueta y el UUID de cada partición.
+ *
+ * @param out Flujo donde se imprime la tabla.
+ * @param parts Particiones con el campo `fs` ya completado (ver listpart_probe_filesystems()).
+ * @param count Cantidad de particiones.
+ */
+void print_fs_table(FILE *out, const listpart_partition *parts, unsigned int count);
+/**
+ * @brief escribe la cabecera del gpt como objeto JSON
+ * @param w escritor JSON
+ * @param key nombre del miembro que contiene la cabecera
+ * @param hdr es la cabecera
+ */
+void json_gpt_header(json_writer *w, const char *key, const gpt_header *hdr);
+/**
+ * @brief Escribe una partición encontrada por la biblioteca como objeto JSON.
+ *
+ * @param w Escritor JSON, dentro de un arreglo.
+ * @param result Resultado al que pertenece la partición: su esquema
+ *               determina los campos escritos, y `allocated_bytes` se
+ *               escribe solo si el disco informa sus huecos.
+ * @param part Partición.
+ */
+void json_listpart_partition(json_writer *w, const listpart_result *result, const listpart_partition *part);
+
+/**
+ * @brief Escribe los campos del análisis de un disco: tamaños de sector,
+ * esquema, cabecera GPT, particiones y estado.
+ *
+ * @param w Escritor JSON, dentro del objeto del dispositivo.
+ * @param result Resultado de listpart_parse_disk().
+ */
+void json_listpart_result(json_writer *w, const listpart_result *result);
+
+/**
+ * @brief Escribe la cantidad y el tiempo de cada fase medida y los bytes leídos.
+ *
+ * @param w Escritor JSON.
+ * @param key Nombre del miembro que contiene el objeto.
+ * @param totals Mediciones de un dispositivo (ver stats_since()).
+ */
+void json_stats(json_writer *w, const char *key, const stats_totals *totals);
+
+#endif
@@ -0,0 +1,768 @@
+/**
+ * @file recover.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "recover.h"
+#include "fsprobe.h"
+#include "gpt.h"
+#include "mbr.h"
+#include "print.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define RECOVER_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/*
+ * Palabras de 32 bits (little endian) que se comparan en cada bloque antes
+ * de verificar la firma completa.
+ */
+#define MAGIC_EFI 0x20494645u   ///< "EFI " en el desplazamiento 0.
+#define MAGIC_XFS 0x42534658u   ///< "XFSB" en el desplazamiento 0.
+#define MAGIC_LUKS 0x534B554Cu  ///< "LUKS" en el desplazamiento 0.
+#define MAGIC_LVM 0x4542414Cu   ///< "LABE" en el desplazamiento 0.
+#define MAGIC_EXT 0xEF53u       ///< 16 bits en el desplazamiento 56.
+#define MAGIC_BTRFS 0x5248425Fu ///< "_BHR" en el desplazamiento 64.
+#define MAGIC_SWAP 0x50415753u  ///< "SWAP" en el desplazamiento 502.
+#define MAGIC_BOOT 0xAA55u      ///< 16 bits en el desplazamiento 510.
+
+/** @brief Desplazamiento del superbloque de Btrfs desde el inicio del volumen. */
+#define RECOVER_BTRFS_SB (64 * 1024)
+
+/** @brief Tamaño de página que se supone para las áreas de swap. */
+#define RECOVER_SWAP_PAGE 4096
+
+/** @brief Buscador de firmas en un buffer. */
+typedef size_t (*recover_kernel)(const unsigned char *buf, size_t blocks, recover_hit *hits);
+
+static recover_kernel recover_selected;
+static const char *recover_selected_name;
+static pthread_once_t recover_once = PTHREAD_ONCE_INIT;
+
+static unsigned int le16(const unsigned char *p) {
+	return (unsigned int)p[0] | (unsigned int)p[1] << 8;
+}
+
+static unsigned int le32(const unsigned char *p) {
+	return le16(p) | (unsigned int)le16(p + 2) << 16;
+}
+
+static unsigned long long le64(const unsigned char *p) {
+	return (unsigned long long)le32(p) | (unsigned long long)le32(p + 4) << 32;
+}
+
+/**
+ * @brief Verifica las firmas completas de un bloque que pasó el filtro.
+ *
+ * @return unsigned int Firmas encontradas (RECOVER_HIT_*).
+ */
+static unsigned int classify_block(const unsigned char *b) {
+	unsigned int mask = 0;
+
+	if (le16(b + 510) == MAGIC_BOOT) {
+		mask |= RECOVER_HIT_BOOT;
+	}
+	if (memcmp(b, "EFI PART", 8) == 0) {
+		mask |= RECOVER_HIT_GPT;
+	}
+	if (le16(b + 56) == MAGIC_EXT) {
+		mask |= RECOVER_HIT_EXT;
+	}
+	if (memcmp(b, "XFSB", 4) == 0) {
+		mask |= RECOVER_HIT_XFS;
+	}
+	if (memcmp(b + 64, "_BHRfS_M", 8) == 0) {
+		mask |= RECOVER_HIT_BTRFS;
+	}
+	if (memcmp(b + 502, "SWAPSPACE2", 10) == 0) {
+		mask |= RECOVER_HIT_SWAP;
+	}
+	if (memcmp(b, "LUKS\xba\xbe", 6) == 0) {
+		mask |= RECOVER_HIT_LUKS;
+	}
+	if (memcmp(b, "LABELONE", 8) == 0) {
+		mask |= RECOVER_HIT_LVM;
+	}
+	return mask;
+}
+
+static size_t search_scalar(const unsigned char *buf, size_t blocks, recover_hit *hits) {
+	size_t n = 0;
+
+	for (size_t i = 0; i < blocks; i++) {
+		const unsigned char *b = buf + i * RECOVER_BLOCK_SIZE;
+		unsigned int w0 = le32(b);
+		// Filtro con las mismas palabras que la versión vectorial
+		if (w0 != MAGIC_EFI && w0 != MAGIC_XFS && w0 != MAGIC_LUKS && w0 != MAGIC_LVM
+				&& le16(b + 56) != MAGIC_EXT && le32(b + 64) != MAGIC_BTRFS
+				&& le32(b + 502) != MAGIC_SWAP && le16(b + 510) != MAGIC_BOOT) {
+			continue;
+		}
+		unsigned int mask = classify_block(b);
+		if (mask != 0) {
+			hits[n].block = i;
+			hits[n].mask = mask;
+			n++;
+		}
+	}
+	return n;
+}
+
+#ifdef RECOVER_HAVE_AVX2
+
+/**
+ * @brief Filtro de ocho bloques por iteración.
+ *
+ * Cada carga dispersa trae la palabra de 32 bits de un mismo desplazamiento
+ * en los ocho bloques; las comparaciones se combinan en una máscara de un
+ * bit por bloque y solo los bloques marcados se clasifican.
+ */
+__attribute__((target("avx2")))
+static size_t search_avx2(const unsigned char *buf, size_t blocks, recover_hit *hits) {
+	const __m256i index = _mm256_setr_epi32(0, 1 * RECOVER_BLOCK_SIZE, 2 * RECOVER_BLOCK_SIZE, 3 * RECOVER_BLOCK_SIZE,
+			4 * RECOVER_BLOCK_SIZE, 5 * RECOVER_BLOCK_SIZE, 6 * RECOVER_BLOCK_SIZE, 7 * RECOVER_BLOCK_SIZE);
+	const __m256i efi = _mm256_set1_epi32((int)MAGIC_EFI);
+	const __m256i xfs = _mm256_set1_epi32((int)MAGIC_XFS);
+	const __m256i luks = _mm256_set1_epi32((int)MAGIC_LUKS);
+	const __m256i lvm = _mm256_set1_epi32((int)MAGIC_LVM);
+	const __m256i ext = _mm256_set1_epi32((int)MAGIC_EXT);
+	const __m256i btrfs = _mm256_set1_epi32((int)MAGIC_BTRFS);
+	const __m256i swap = _mm256_set1_epi32((int)MAGIC_SWAP);
+	const __m256i boot = _mm256_set1_epi32((int)MAGIC_BOOT);
+	const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+	size_t n = 0;
+	size_t i = 0;
+
+	for (; i + 8 <= blocks; i += 8) {
+		const unsigned char *base = buf + i * RECOVER_BLOCK_SIZE;
+		__m256i w0 = _mm256_i32gather_epi32((const int *)base, index, 1);
+		__m256i w56 = _mm256_i32gather_epi32((const int *)(base + 56), index, 1);
+		__m256i w64 = _mm256_i32gather_epi32((const int *)(base + 64), index, 1);
+		__m256i w502 = _mm256_i32gather_epi32((const int *)(base + 502), index, 1);
+		__m256i w508 = _mm256_i32gather_epi32((const int *)(base + 508), index, 1);
+		__m256i any = _mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi32(w0, efi), _mm256_cmpeq_epi32(w0, xfs)),
+				_mm256_or_si256(_mm256_cmpeq_epi32(w0, luks), _mm256_cmpeq_epi32(w0, lvm)));
+		any = _mm256_or_si256(any, _mm256_cmpeq_epi32(_mm256_and_si256(w56, low16), ext));
+		any = _mm256_or_si256(any, _mm256_cmpeq_epi32(w64, btrfs));
+		any = _mm256_or_si256(any, _mm256_cmpeq_epi32(w502, swap));
+		any = _mm256_or_si256(any, _mm256_cmpeq_epi32(_mm256_srli_epi32(w508, 16), boot));
+
+		unsigned int bits = (unsigned int)_mm256_movemask_ps(_mm256_castsi256_ps(any));
+		while (bits != 0) {
+			unsigned int k = (unsigned int)__builtin_ctz(bits);
+			unsigned int mask = classify_block(base + (size_t)k * RECOVER_BLOCK_SIZE);
+			bits &= bits - 1;
+			if (mask != 0) {
+				hits[n].block = i + k;
+				hits[n].mask = mask;
+				n++;
+			}
+		}
+	}
+	// Los bloques que no completan un grupo de ocho
+	size_t tail = search_scalar(buf + i * RECOVER_BLOCK_SIZE, blocks - i, hits + n);
+	for (size_t k = n; k < n + tail; k++) {
+		hits[k].block += i;
+	}
+	return n + tail;
+}
+
+#endif
+
+static void recover_init(void) {
+	recover_selected = search_scalar;
+	recover_selected_name = "escalar";
+#ifdef RECOVER_HAVE_AVX2
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		recover_selected = search_avx2;
+		recover_selected_name = "avx2";
+	}
+#endif
+}
+
+size_t recover_search(const unsigned char *buf, size_t blocks, recover_hit *hits) {
+	pthread_once(&recover_once, recover_init);
+	return recover_selected(buf, blocks, hits);
+}
+
+const char *recover_search_impl_name(void) {
+	pthread_once(&recover_once, recover_init);
+	return recover_selected_name;
+}
+
+/**
+ * @struct recover_boot
+ * @brief Sector de arranque con una tabla de particiones coherente.
+ */
+typedef struct {
+	unsigned long long lba;  ///< Sector donde se encontró.
+	int ebr;                 ///< 1 si tiene la forma de un EBR (solo las dos primeras entradas).
+	mbr record;              ///< Contenido del sector.
+} recover_boot;
+
+/**
+ * @struct recover_findings
+ * @brief Estructuras encontradas durante el recorrido.
+ */
+typedef struct {
+	gpt_header *gpt;               ///< Cabeceras GPT válidas.
+	size_t gpt_count;              ///< Cabeceras en `gpt`.
+	size_t gpt_capacity;           ///< Capacidad de `gpt`.
+	recover_boot *boot;            ///< Sectores de arranque con tabla.
+	size_t boot_count;             ///< Sectores en `boot`.
+	size_t boot_capacity;          ///< Capacidad de `boot`.
+	unsigned long long *fs_lba;    ///< Posibles inicios de sistemas de archivos.
+	size_t fs_count;               ///< Inicios en `fs_lba`.
+	size_t fs_capacity;            ///< Capacidad de `fs_lba`.
+	unsigned long long sectors;    ///< Sectores del dispositivo.
+	unsigned long long holes;      ///< Sectores en huecos que se saltaron sin leer.
+	unsigned int sector_size;      ///< Tamaño de sector lógico.
+} recover_findings;
+
+/**
+ * @brief Agrega un elemento al final de un arreglo que crece según haga falta.
+ *
+ * @return int 1 si se agregó, 0 si no hay memoria.
+ */
+static int append(void **items, size_t *count, size_t *capacity, size_t size, const void *item) {
+	if (*count == *capacity) {
+		size_t grown = *capacity > 0 ? *capacity * 2 : 16;
+		void *p = realloc(*items, grown * size);
+		if (p == NULL) {
+			return 0;
+		}
+		*items = p;
+		*capacity = grown;
+	}
+	memcpy((char *)*items + *count * size, item, size);
+	(*count)++;
+	return 1;
+}
+
+/**
+ * @brief Registra un posible inicio de sistema de archivos a `offset` bytes.
+ */
+static void add_fs(recover_findings *found, unsigned long long offset) {
+	unsigned long long lba = offset / found->sector_size;
+
+	if (offset % found->sector_size == 0 && lba < found->sectors) {
+		append((void **)&found->fs_lba, &found->fs_count, &found->fs_capacity, sizeof(lba), &lba);
+	}
+}
+
+/**
+ * @brief Verifica que un sector con 0xAA55 contenga una tabla de particiones coherente.
+ *
+ * Las entradas usadas deben tener un indicador de arranque válido, tamaño
+ * distinto de cero y caber en el disco; las vacías, estar en cero. Un EBR
+ * usa solo las dos primeras entradas.
+ *
+ * @return int 1 si la tabla es coherente, 0 en caso contrario.
+ */
+static int plausible_table(const mbr *record, unsigned long long lba, unsigned long long sectors, int *ebr) {
+	static const mbr_partition_descriptor empty;
+	int used = 0;
+
+	*ebr = 1;
+	for (int i = 0; i < 4; i++) {
+		const mbr_partition_descriptor *part = &record->partition_table[i];
+		if (part->partition_type == MBR_TYPE_UNUSED) {
+			if (memcmp(part, &empty, sizeof(empty)) != 0) {
+				return 0;
+			}
+			continue;
+		}
+		if ((part->boot_flag != 0x00 && part->boot_flag != 0x80) || part->size == 0 || part->start_lba == 0
+				|| lba + part->start_lba + part->size > sectors) {
+			return 0;
+		}
+		used++;
+		if (i >= 2) {
+			*ebr = 0;
+		}
+	}
+	// Una tabla sin entradas no aporta nada; en el sector 0 siempre es un MBR
+	if (lba == 0) {
+		*ebr = 0;
+	}
+	return used > 0;
+}
+
+/**
+ * @brief Verifica si un sector con 0xAA55 es el sector de arranque de un sistema de archivos.
+ */
+static int fs_boot_sector(const unsigned char *b) {
+	return memcmp(b + 3, "NTFS    ", 8) == 0 || memcmp(b + 3, "EXFAT   ", 8) == 0
+		|| ((b[0] == 0xEB || b[0] == 0xE9) && (memcmp(b + 0x36, "FAT", 3) == 0 || memcmp(b + 0x52, "FAT32   ", 8) == 0));
+}
+
+/**
+ * @brief Interpreta un bloque con firmas encontrado a `offset` bytes del inicio del disco.
+ *
+ * Solo se usan los datos del bloque; lo que requiere leer más del disco se
+ * verifica después del recorrido.
+ */
+static void examine_hit(recover_findings *found, const unsigned char *b, unsigned long long offset, unsigned int mask) {
+	int aligned = offset % found->sector_size == 0;
+
+	if ((mask & RECOVER_HIT_BOOT) && aligned) {
+		recover_boot boot;
+		if (fs_boot_sector(b)) {
+			add_fs(found, offset);
+		} else {
+			memcpy(&boot.record, b, sizeof(mbr));
+			boot.lba = offset / found->sector_size;
+			if (plausible_table(&boot.record, boot.lba, found->sectors, &boot.ebr)) {
+				append((void **)&found->boot, &found->boot_count, &found->boot_capacity, sizeof(boot), &boot);
+			}
+		}
+	}
+	if ((mask & RECOVER_HIT_GPT) && aligned) {
+		gpt_header hdr;
+		memcpy(&hdr, b, sizeof(hdr));
+		// Una cabecera copiada en otro lugar (por ejemplo, dentro de una imagen) no indica su propia posición
+		if (is_valid_gpt_header(&hdr) && hdr.my_lba == offset / found->sector_size) {
+			append((void **)&found->gpt, &found->gpt_count, &found->gpt_capacity, sizeof(hdr), &hdr);
+		}
+	}
+	// Los superbloques de respaldo de ext indican un grupo distinto de cero
+	if ((mask & RECOVER_HIT_EXT) && offset >= 1024 && le16(b + 0x5A) == 0 && le32(b + 0x18) <= 6) {
+		add_fs(found, offset - 1024);
+	}
+	if ((mask & RECOVER_HIT_XFS) && aligned) {
+		unsigned int block_size = (unsigned int)b[4] << 24 | (unsigned int)b[5] << 16 | (unsigned int)b[6] << 8 | b[7];
+		if (block_size >= 512 && block_size <= 65536 && (block_size & (block_size - 1)) == 0) {
+			add_fs(found, offset);
+		}
+	}
+	// Las copias del superbloque de Btrfs indican en bytenr su propia posición
+	if ((mask & RECOVER_HIT_BTRFS) && offset >= RECOVER_BTRFS_SB && le64(b + 0x30) == RECOVER_BTRFS_SB) {
+		add_fs(found, offset - RECOVER_BTRFS_SB);
+	}
+	if ((mask & RECOVER_HIT_SWAP) && offset + RECOVER_BLOCK_SIZE >= RECOVER_SWAP_PAGE) {
+		add_fs(found, offset + RECOVER_BLOCK_SIZE - RECOVER_SWAP_PAGE);
+	}
+	if ((mask & RECOVER_HIT_LUKS) && aligned) {
+		add_fs(found, offset);
+	}
+	// La etiqueta LVM indica en qué sector de 512 bytes del volumen está
+	if ((mask & RECOVER_HIT_LVM) && le64(b + 8) < 4 && offset >= le64(b + 8) * 512) {
+		add_fs(found, offset - le64(b + 8) * 512);
+	}
+}
+
+/**
+ * @brief Busca en un buffer leído desde `lba` y registra lo que encuentre.
+ */
+static void search_chunk(recover_findings *found, const unsigned char *buf, unsigned long long lba,
+		unsigned long long sectors, recover_hit *hits) {
+	unsigned long long base = lba * found->sector_size;
+	size_t n = recover_search(buf, (size_t)(sectors * found->sector_size / RECOVER_BLOCK_SIZE), hits);
+
+	for (size_t i = 0; i < n; i++) {
+		examine_hit(found, buf + hits[i].block * RECOVER_BLOCK_SIZE, base + (unsigned long long)hits[i].block * RECOVER_BLOCK_SIZE,
+				hits[i].mask);
+	}
+}
+
+/**
+ * @brief Primer bloque del recorrido, desde `lba`, que puede contener datos.
+ *
+ * Un bloque que cae completo en un hueco (ver disk_next_data()) se lee como
+ * ceros y no puede contener firmas, así que se salta sin leerlo. `data`
+ * conserva el último tramo con datos encontrado para no consultarlo en cada
+ * bloque.
+ *
+ * @return unsigned long long Primer sector del bloque, o `sectors` si no quedan datos.
+ */
+static unsigned long long next_chunk(disk_handle *disk, unsigned long long lba, unsigned long long chunk,
+		unsigned long long sectors, unsigned long long data[2]) {
+	if (lba >= sectors) {
+		return lba;
+	}
+	if (lba >= data[1]) {
+		int found = disk_next_data(disk, lba, &data[0], &data[1]);
+		if (found == 0) {
+			return sectors;
+		}
+		if (found < 0) {
+			data[0] = lba;
+			data[1] = sectors;
+		}
+	}
+	if (data[0] >= lba + chunk) {
+		lba = data[0] - data[0] % chunk;
+	}
+	return lba;
+}
+
+/**
+ * @struct recover_stream
+ * @brief Lectura del dispositivo con dos buffers, compartida con el hilo lector.
+ *
+ * El hilo lector llena el buffer `k % 2` con el bloque `k` mientras el hilo
+ * principal busca en el otro. Un buffer lleno con `count[i] == 0` marca el
+ * final del recorrido.
+ */
+typedef struct {
+	disk_handle *disk;                  ///< Dispositivo a recorrer.
+	unsigned long long sectors;         ///< Sectores del dispositivo.
+	unsigned long long chunk_sectors;   ///< Sectores de cada lectura.
+	unsigned long long holes;           ///< Sectores saltados por estar en huecos (solo el hilo lector).
+	unsigned char *buf[2];              ///< Buffers alineados de RECOVER_CHUNK_SIZE bytes.
+	unsigned long long lba[2];          ///< Primer sector de cada buffer.
+	unsigned long long count[2];        ///< Sectores de cada buffer.
+	int read_ok[2];                     ///< 0 si la lectura del buffer falló.
+	int full[2];                        ///< 1 mientras el buffer espera la búsqueda.
+	pthread_mutex_t lock;               ///< Protege `lba`, `count`, `read_ok` y `full`.
+	pthread_cond_t cond;                ///< Señala los cambios de `full`.
+} recover_stream;
+
+/**
+ * @brief Espera a que el buffer `slot` esté en el estado `full`.
+ */
+static void wait_slot(recover_stream *s, int slot, int full) {
+	pthread_mutex_lock(&s->lock);
+	while (s->full[slot] != full) {
+		pthread_cond_wait(&s->cond, &s->lock);
+	}
+	pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * @brief Publica el buffer `slot` con los sectores `lba` .. `lba + count - 1`.
+ */
+static void publish_slot(recover_stream *s, int slot, unsigned long long lba, unsigned long long count, int ok) {
+	pthread_mutex_lock(&s->lock);
+	s->lba[slot] = lba;
+	s->count[slot] = count;
+	s->read_ok[slot] = ok;
+	s->full[slot] = 1;
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+}
+
+/**
+ * @brief Hilo lector: recorre el dispositivo en orden, un bloque por buffer libre.
+ */
+static void *reader_thread(void *arg) {
+	recover_stream *s = (recover_stream *)arg;
+	unsigned long long lba = 0;
+	unsigned long long data[2] = { 0, 0 };
+	int slot = 0;
+
+	for (;; lba += s->chunk_sectors, slot ^= 1) {
+		unsigned long long next = next_chunk(s->disk, lba, s->chunk_sectors, s->sectors, data);
+		s->holes += next - lba;
+		if ((lba = next) >= s->sectors) {
+			break;
+		}
+		unsigned long long n = s->sectors - lba < s->chunk_sectors ? s->sectors - lba : s->chunk_sectors;
+		wait_slot(s, slot, 0);
+		publish_slot(s, slot, lba, n, disk_read(s->disk, lba, n, s->buf[slot]));
+	}
+	wait_slot(s, slot, 0);
+	publish_slot(s, slot, lba, 0, 1);
+	return NULL;
+}
+
+/**
+ * @brief Recorre el dispositivo con el hilo lector y busca en cada bloque leído.
+ *
+ * @return unsigned long long Sectores que no se pudieron leer.
+ */
+static unsigned long long stream_device(disk_handle *disk, recover_findings *found, recover_hit *hits, int *ok) {
+	recover_stream s;
+	pthread_t reader;
+	unsigned long long unreadable = 0;
+	void *buf[2] = { NULL, NULL };
+
+	memset(&s, 0, sizeof(s));
+	*ok = 0;
+	// Buffers alineados a 4 KiB, como los que requiere la lectura directa del dispositivo
+	if (posix_memalign(&buf[0], 4096, RECOVER_CHUNK_SIZE) != 0 || posix_memalign(&buf[1], 4096, RECOVER_CHUNK_SIZE) != 0) {
+		free(buf[0]);
+		return 0;
+	}
+	s.disk = disk;
+	s.sectors = found->sectors;
+	s.chunk_sectors = RECOVER_CHUNK_SIZE / disk->sector_size;
+	s.buf[0] = (unsigned char *)buf[0];
+	s.buf[1] = (unsigned char *)buf[1];
+	pthread_mutex_init(&s.lock, NULL);
+	pthread_cond_init(&s.cond, NULL);
+	if (pthread_create(&reader, NULL, reader_thread, &s) == 0) {
+		*ok = 1;
+		for (int slot = 0;; slot ^= 1) {
+			wait_slot(&s, slot, 1);
+			if (s.count[slot] == 0) {
+				break;
+			}
+			if (s.read_ok[slot]) {
+				search_chunk(found, s.buf[slot], s.lba[slot], s.count[slot], hits);
+			} else {
+				unreadable += s.count[slot];
+			}
+			pthread_mutex_lock(&s.lock);
+			s.full[slot] = 0;
+			pthread_cond_broadcast(&s.cond);
+			pthread_mutex_unlock(&s.lock);
+		}
+		pthread_join(reader, NULL);
+		found->holes = s.holes;
+	}
+	pthread_cond_destroy(&s.cond);
+	pthread_mutex_destroy(&s.lock);
+	free(buf[0]);
+	free(buf[1]);
+	return unreadable;
+}
+
+static int compare_lba(const void *a, const void *b) {
+	unsigned long long x = *(const unsigned long long *)a;
+	unsigned long long y = *(const unsigned long long *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Imprime las cabeceras GPT encontradas y la primera tabla que se pueda leer completa.
+ */
+static void report_gpt(FILE *out, disk_handle *disk, const recover_findings *found) {
+	int printed = 0;
+
+	if (found->gpt_count == 0) {
+		return;
+	}
+	fprintf(out, "\nCabeceras GPT encontradas:\n");
+	for (size_t i = 0; i < found->gpt_count; i++) {
+		gpt_header hdr = found->gpt[i];
+		unsigned char *entries = gpt_read_partition_array(disk, &hdr);
+		int valid = entries != NULL && gpt_entry_array_crc_valid(&hdr, entries);
+
+		fprintf(out, "  LBA %llu: cabecera %s, %u descriptores en LBA %llu, arreglo %s\n",
+				hdr.my_lba, hdr.my_lba < hdr.alternate_lba ? "primaria" : "de respaldo",
+				hdr.num_partition_entries, hdr.partition_entry_lba,
+				entries == NULL ? "ilegible" : valid ? "valido" : "INVALIDO");
+		if (valid && !printed) {
+			fprintf(out, "\nTabla GPT recuperada desde la cabecera en LBA %llu:\n", hdr.my_lba);
+			print_gpt_header(out, &hdr, disk->sector_size);
+			fprintf(out, "\nStart LBA       End LBA         Size            Type                            Partition Name\n");
+			fprintf(out, "------------    ------------    ------------    ------------------------------   --------------------\n");
+			for (unsigned int j = 0; j < hdr.num_partition_entries; j++) {
+				gpt_partition_descriptor *desc =
+					(gpt_partition_descriptor *)(entries + (size_t)j * hdr.size_partition_entry);
+				if (!is_null_descriptor(desc)) {
+					print_gpt_partition_table(out, desc, disk->sector_size);
+				}
+			}
+			fprintf(out, "------------    ------------    ------------    ------------------------------   --------------------\n");
+			printed = 1;
+		}
+		free(entries);
+	}
+}
+
+/**
+ * @brief Imprime los sectores de arranque con una tabla de particiones coherente.
+ */
+static void report_boot(FILE *out, const recover_findings *found) {
+	if (found->boot_count == 0) {
+		return;
+	}
+	fprintf(out, "\nSectores de arranque con tabla de particiones:\n");
+	for (size_t i = 0; i < found->boot_count; i++) {
+		const recover_boot *boot = &found->boot[i];
+		fprintf(out, "  LBA %llu: %s\n", boot->lba, boot->ebr ? "EBR" : "MBR");
+		for (int j = 0; j < 4; j++) {
+			const mbr_partition_descriptor *part = &boot->record.partition_table[j];
+			if (part->partition_type == MBR_TYPE_UNUSED) {
+				continue;
+			}
+			// En un EBR la primera entrada es relativa al propio EBR y la segunda a la extendida
+			if (boot->ebr && j == 1) {
+				fprintf(out, "    Siguiente EBR: tipo 0x%02X, desplazamiento %u en la extendida, %u sectores\n",
+						part->partition_type, part->start_lba, part->size);
+			} else {
+				fprintf(out, "    Tipo 0x%02X (%s), inicio LBA %llu, %u sectores%s\n",
+						part->partition_type, mbr_partition_type_name(part->partition_type),
+						(boot->ebr ? boot->lba : 0) + part->start_lba, part->size,
+						part->boot_flag == 0x80 ? ", activa" : "");
+			}
+		}
+	}
+}
+
+/**
+ * @brief Tipo de partición GPT que corresponde a un sistema de archivos.
+ */
+static const char *suggested_type(const char *fs) {
+	if (strcmp(fs, "swap") == 0) {
+		return "Linux swap";
+	}
+	if (strcmp(fs, "crypto_LUKS") == 0) {
+		return "Linux LUKS";
+	}
+	if (strcmp(fs, "LVM2_member") == 0) {
+		return "Linux LVM";
+	}
+	if (strcmp(fs, "ntfs") == 0 || strcmp(fs, "exfat") == 0 || strncmp(fs, "fat", 3) == 0) {
+		return "Microsoft basic data";
+	}
+	return "Linux filesystem";
+}
+
+/**
+ * @brief Identifica los sistemas de archivos encontrados e imprime la tabla candidata.
+ *
+ * Un inicio que cae dentro del volumen anterior es una copia (superbloque
+ * secundario de XFS, sector de arranque de respaldo de FAT, NTFS o exFAT) y
+ * se descarta. Si el superbloque no indica el tamaño, la partición se
+ * extiende hasta el inicio siguiente o el final del disco.
+ */
+static int report_filesystems(FILE *out, disk_handle *disk, recover_findings *found) {
+	fsprobe_request *reqs;
+	fsprobe_info *info;
+	size_t n = 0;
+
+	if (found->fs_count == 0) {
+		fprintf(out, "\nNo se encontraron sistemas de archivos.\n");
+		return 1;
+	}
+	qsort(found->fs_lba, found->fs_count, sizeof(unsigned long long), compare_lba);
+	for (size_t i = 0; i < found->fs_count; i++) {
+		if (n == 0 || found->fs_lba[i] != found->fs_lba[n - 1]) {
+			found->fs_lba[n++] = found->fs_lba[i];
+		}
+	}
+	found->fs_count = n;
+
+	reqs = (fsprobe_request *)malloc(n * sizeof(fsprobe_request));
+	info = (fsprobe_info *)malloc(n * sizeof(fsprobe_info));
+	if (reqs == NULL || info == NULL) {
+		free(reqs);
+		free(info);
+		return 0;
+	}
+	for (size_t i = 0; i < n; i++) {
+		reqs[i].start_lba = found->fs_lba[i];
+		reqs[i].sectors = found->sectors - found->fs_lba[i];
+		reqs[i].info = &info[i];
+	}
+	fsprobe_partitions(disk, reqs, (int)n);
+
+	fprintf(out, "\nTabla de particiones candidata:\n");
+	fprintf(out, "---------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+	fprintf(out, "|  # |  Inicio LBA  |    Fin LBA     |   Tamano   |         Tipo sugerido          | Sist. archivos |     Etiqueta     |                  UUID                  |\n");
+	fprintf(out, "---------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+	unsigned int number = 0;
+	int estimated = 0;
+	unsigned long long next_free = 0; // Primer sector después del último volumen aceptado
+	for (size_t i = 0; i < n; i++) {
+		unsigned long long start = reqs[i].start_lba;
+		unsigned long long end;
+		int guess = info[i].size_bytes == 0;
+
+		if (info[i].type == NULL || start < next_free) {
+			continue;
+		}
+		if (!guess) {
+			end = start + (info[i].size_bytes + found->sector_size - 1) / found->sector_size - 1;
+		} else {
+			end = found->sectors - 1;
+			for (size_t j = i + 1; j < n; j++) {
+				if (info[j].type != NULL) {
+					end = reqs[j].start_lba - 1;
+					break;
+				}
+			}
+		}
+		if (end >= found->sectors) {
+			end = found->sectors - 1;
+		}
+		next_free = end + 1;
+		estimated |= guess;
+		fprintf(out, "| %2u | %12llu | %12llu%s | %7llu MB | %30s | %14s | %16.16s | %38s |\n",
+				++number, start, end, guess ? " *" : "  ",
+				(end - start + 1) * found->sector_size / (1024 * 1024),
+				suggested_type(info[i].type), info[i].type, info[i].label, info[i].uuid);
+	}
+	fprintf(out, "---------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+	if (estimated) {
+		fprintf(out, "* El superbloque no indica el tamano: el fin se estima hasta la siguiente firma o el final del disco.\n");
+	}
+	free(reqs);
+	free(info);
+	return 1;
+}
+
+int recover_scan(FILE *out, disk_handle *disk) {
+	recover_findings found;
+	recover_hit *hits;
+	struct timespec t0, t1;
+	unsigned long long unreadable = 0;
+	int ok = 1;
+
+	memset(&found, 0, sizeof(found));
+	found.sector_size = disk->sector_size;
+	found.sectors = disk->size_bytes / disk->sector_size;
+	if (found.sectors == 0) {
+		fprintf(stderr, "Error: No se conoce el tamano del dispositivo %s\n", disk->path);
+		return 0;
+	}
+	hits = (recover_hit *)malloc(RECOVER_CHUNK_SIZE / RECOVER_BLOCK_SIZE * sizeof(recover_hit));
+	if (hits == NULL) {
+		return 0;
+	}
+
+	fprintf(out, "Buscando particiones perdidas en %s: %llu sectores de %u bytes (busqueda %s)\n",
+			disk->path, found.sectors, found.sector_size, recover_search_impl_name());
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if (disk->memory != NULL) {
+		// La imagen ya está en memoria: se busca en su lugar, sin hilo lector
+		unsigned long long chunk = RECOVER_CHUNK_SIZE / disk->sector_size;
+		unsigned long long data[2] = { 0, 0 };
+		for (unsigned long long lba = 0;; lba += chunk) {
+			unsigned long long next = next_chunk(disk, lba, chunk, found.sectors, data);
+			found.holes += next - lba;
+			if ((lba = next) >= found.sectors) {
+				break;
+			}
+			unsigned long long count = found.sectors - lba < chunk ? found.sectors - lba : chunk;
+			search_chunk(&found, (const unsigned char *)disk_view(disk, lba, count), lba, count, hits);
+		}
+	} else {
+		unreadable = stream_device(disk, &found, hits, &ok);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	free(hits);
+
+	if (ok) {
+		double seconds = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+		double mib = (double)found.sectors * found.sector_size / (1024 * 1024);
+		fprintf(out, "Recorrido completo: %.0f MiB en %.2f s (%.1f MiB/s)\n", mib, seconds,
+				seconds > 0 ? mib / seconds : 0.0);
+		if (found.holes > 0) {
+			fprintf(out, "Huecos saltados sin leer: %llu MiB\n", found.holes * found.sector_size / (1024 * 1024));
+		}
+		if (unreadable > 0) {
+			fprintf(out, "Sectores ilegibles omitidos: %llu\n", unreadable);
+			fprintf(stderr, "Advertencia: Se omitieron %llu sectores ilegibles del dispositivo %s\n", unreadable, disk->path);
+		}
+		report_gpt(out, disk, &found);
+		report_boot(out, &found);
+		ok = report_filesystems(out, disk, &found);
+	}
+	free(found.gpt);
+	free(found.boot);
+	free(found.fs_lba);
+	return ok;
+}
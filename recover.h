@@ -0,0 +1,109 @@
+/**
+ * @file recover.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Búsqueda de particiones perdidas recorriendo todo el dispositivo.
+ *
+ * Cuando el primer sector está borrado no hay tabla que leer: se recorre el
+ * dispositivo completo en bloques grandes y alineados, y en cada bloque de
+ * 512 bytes se buscan las firmas que delatan el comienzo de una estructura:
+ *
+ * - 0xAA55 al final del bloque (MBR, EBR y sectores de arranque FAT/NTFS/exFAT).
+ * - "EFI PART" al comienzo (cabeceras GPT primaria y de respaldo).
+ * - Los números mágicos de los superbloques de ext2/3/4, XFS, Btrfs, swap,
+ *   LUKS y LVM.
+ *
+ * La búsqueda examina unos pocos desplazamientos fijos por bloque; con AVX2
+ * se examinan ocho bloques a la vez con cargas dispersas (gather) y solo los
+ * bloques con alguna coincidencia se clasifican uno por uno. Un hilo lector
+ * llena un buffer mientras se busca en el otro, de modo que la búsqueda se
+ * solapa con la lectura y el recorrido avanza al ritmo del disco.
+ *
+ * Con las firmas encontradas se reconstruyen las tablas posibles: las
+ * tablas GPT cuyas cabeceras siguen siendo válidas, los sectores de
+ * arranque con una tabla MBR o EBR coherente y una tabla candidata formada
+ * por los sistemas de archivos encontrados, con su extensión según el
+ * superbloque.
+ * @copyright MIT License
+ */
+#ifndef RECOVER_H
+#define RECOVER_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "disk.h"
+
+/**
+ * @def RECOVER_CHUNK_SIZE
+ * @brief Bytes de cada lectura del recorrido (y de cada uno de los dos buffers).
+ */
+#define RECOVER_CHUNK_SIZE (4 * 1024 * 1024)
+
+/**
+ * @def RECOVER_BLOCK_SIZE
+ * @brief Unidad de la búsqueda: las firmas se buscan en bloques de 512 bytes
+ *        aunque el sector lógico sea de 4096.
+ */
+#define RECOVER_BLOCK_SIZE 512
+
+/** @brief Bloque con 0xAA55 en los bytes 510-511. */
+#define RECOVER_HIT_BOOT 0x01
+/** @brief Bloque que empieza con "EFI PART". */
+#define RECOVER_HIT_GPT 0x02
+/** @brief Bloque con el número mágico de ext2/3/4 (0xEF53) en el desplazamiento 56. */
+#define RECOVER_HIT_EXT 0x04
+/** @brief Bloque que empieza con "XFSB". */
+#define RECOVER_HIT_XFS 0x08
+/** @brief Bloque con "_BHRfS_M" en el desplazamiento 64 (superbloque de Btrfs). */
+#define RECOVER_HIT_BTRFS 0x10
+/** @brief Bloque que termina con "SWAPSPACE2" (final de la primera página de swap). */
+#define RECOVER_HIT_SWAP 0x20
+/** @brief Bloque que empieza con la cabecera de LUKS. */
+#define RECOVER_HIT_LUKS 0x40
+/** @brief Bloque que empieza con "LABELONE" (etiqueta de un volumen físico LVM). */
+#define RECOVER_HIT_LVM 0x80
+
+/**
+ * @struct recover_hit
+ * @brief Bloque con al menos una firma.
+ *
+ * @var recover_hit::block
+ * Índice del bloque de RECOVER_BLOCK_SIZE bytes dentro del buffer.
+ * @var recover_hit::mask
+ * Firmas encontradas (RECOVER_HIT_*).
+ */
+typedef struct {
+	size_t block;
+	unsigned int mask;
+} recover_hit;
+
+/**
+ * @brief Busca las firmas en un buffer.
+ *
+ * @param buf Buffer a examinar.
+ * @param blocks Cantidad de bloques de RECOVER_BLOCK_SIZE bytes del buffer.
+ * @param hits Donde se guardan los bloques con firmas, en orden; debe tener
+ *             lugar para `blocks` elementos.
+ * @return size_t Cantidad de bloques con firmas.
+ */
+size_t recover_search(const unsigned char *buf, size_t blocks, recover_hit *hits);
+
+/**
+ * @brief Nombre de la implementación de recover_search() elegida para esta CPU.
+ *
+ * @return "avx2" o "escalar".
+ */
+const char *recover_search_impl_name(void);
+
+/**
+ * @brief Recorre un dispositivo completo e informa las particiones que encuentre.
+ *
+ * Los sectores que no se pueden leer se saltean y se informan al final.
+ *
+ * @param out Flujo donde se escribe el informe.
+ * @param disk Dispositivo abierto.
+ * @return int 1 si el recorrido terminó, 0 si no se pudo realizar.
+ */
+int recover_scan(FILE *out, disk_handle *disk);
+
+#endif
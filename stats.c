@@ -0,0 +1,186 @@
+/**
+ * @file stats.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "stats.h"
+
+/**
+ * @brief Bits de subdivisión de cada potencia de dos del histograma.
+ *
+ * Con 8 subdivisiones el percentil se conoce con un error menor al 12.5 %.
+ */
+#define STATS_SUB_BITS 3
+
+/** @brief Cubetas del histograma: duraciones de 0 ns a 2^64 - 1 ns. */
+#define STATS_BUCKETS ((64 - STATS_SUB_BITS + 1) << STATS_SUB_BITS)
+
+/**
+ * @struct stats_thread
+ * @brief Contadores de un hilo. Se enlazan en una lista para el resumen final.
+ */
+typedef struct stats_thread {
+	stats_totals totals;                              ///< Cantidad, tiempo y bytes.
+	unsigned long long hist[STATS_PHASES][STATS_BUCKETS]; ///< Duraciones de cada fase.
+	struct stats_thread *next;                        ///< Siguiente hilo de la lista.
+} stats_thread;
+
+static const char *const stats_names[STATS_PHASES] = { "open", "read", "validate", "lookup", "print" };
+static const char *const stats_labels[STATS_PHASES] = { "apertura", "lectura", "validacion", "tipo", "impresion" };
+
+static int stats_on;
+static __thread stats_thread *stats_local;
+static stats_thread *stats_threads;
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Cubeta de una duración: las 8 primeras son exactas y luego cada
+ *        potencia de dos se divide en 8 partes iguales.
+ */
+static unsigned int stats_bucket(unsigned long long ns) {
+	if (ns < (1u << STATS_SUB_BITS)) {
+		return (unsigned int)ns;
+	}
+	unsigned int msb = 63 - (unsigned int)__builtin_clzll(ns);
+	return ((msb - STATS_SUB_BITS + 1) << STATS_SUB_BITS)
+		| (unsigned int)((ns >> (msb - STATS_SUB_BITS)) & ((1u << STATS_SUB_BITS) - 1));
+}
+
+/**
+ * @brief Punto medio del intervalo de duraciones de una cubeta.
+ */
+static unsigned long long stats_bucket_value(unsigned int bucket) {
+	if (bucket < (1u << STATS_SUB_BITS)) {
+		return bucket;
+	}
+	unsigned int shift = (bucket >> STATS_SUB_BITS) - 1;
+	unsigned long long low = (unsigned long long)((1u << STATS_SUB_BITS) | (bucket & ((1u << STATS_SUB_BITS) - 1))) << shift;
+	return low + ((1ULL << shift) >> 1);
+}
+
+/**
+ * @brief Contadores del hilo que llama, creados en su primera medición.
+ */
+static stats_thread *stats_thread_local(void) {
+	if (stats_local == NULL && (stats_local = (stats_thread *)calloc(1, sizeof(stats_thread))) != NULL) {
+		pthread_mutex_lock(&stats_lock);
+		stats_local->next = stats_threads;
+		stats_threads = stats_local;
+		pthread_mutex_unlock(&stats_lock);
+	}
+	return stats_local;
+}
+
+void stats_enable(void) {
+	stats_on = 1;
+}
+
+int stats_enabled(void) {
+	return stats_on;
+}
+
+unsigned long long stats_begin(void) {
+	struct timespec ts;
+
+	if (!stats_on) {
+		return 0;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+void stats_end(stats_phase phase, unsigned long long start, unsigned long long bytes) {
+	stats_thread *t;
+	unsigned long long ns;
+
+	if (start == 0 || (t = stats_thread_local()) == NULL) {
+		return;
+	}
+	ns = stats_begin() - start;
+	t->totals.count[phase]++;
+	t->totals.total_ns[phase] += ns;
+	t->totals.bytes += bytes;
+	t->hist[phase][stats_bucket(ns)]++;
+}
+
+void stats_snapshot(stats_totals *out) {
+	if (stats_local != NULL) {
+		*out = stats_local->totals;
+	} else {
+		memset(out, 0, sizeof(stats_totals));
+	}
+}
+
+void stats_since(stats_totals *snap) {
+	stats_totals now;
+
+	stats_snapshot(&now);
+	for (int p = 0; p < STATS_PHASES; p++) {
+		snap->count[p] = now.count[p] - snap->count[p];
+		snap->total_ns[p] = now.total_ns[p] - snap->total_ns[p];
+	}
+	snap->bytes = now.bytes - snap->bytes;
+}
+
+const char *stats_phase_name(stats_phase phase) {
+	return stats_names[phase];
+}
+
+/**
+ * @brief Duración del percentil `percent` de un histograma con `count` mediciones.
+ */
+static unsigned long long stats_percentile(const unsigned long long *hist, unsigned long long count, unsigned int percent) {
+	unsigned long long rank = (count * percent + 99) / 100; // Posición (desde 1) de la medición buscada
+	unsigned long long seen = 0;
+
+	for (unsigned int b = 0; b < STATS_BUCKETS; b++) {
+		seen += hist[b];
+		if (seen >= rank && hist[b] > 0) {
+			return stats_bucket_value(b);
+		}
+	}
+	return 0;
+}
+
+void stats_report(FILE *out) {
+	stats_totals totals;
+	unsigned long long *hist = (unsigned long long *)calloc((size_t)STATS_PHASES * STATS_BUCKETS, sizeof(unsigned long long));
+
+	if (hist == NULL) {
+		return;
+	}
+	// Sumar los contadores de todos los hilos
+	memset(&totals, 0, sizeof(totals));
+	pthread_mutex_lock(&stats_lock);
+	for (stats_thread *t = stats_threads; t != NULL; t = t->next) {
+		for (int p = 0; p < STATS_PHASES; p++) {
+			totals.count[p] += t->totals.count[p];
+			totals.total_ns[p] += t->totals.total_ns[p];
+			for (unsigned int b = 0; b < STATS_BUCKETS; b++) {
+				hist[(size_t)p * STATS_BUCKETS + b] += t->hist[p][b];
+			}
+		}
+		totals.bytes += t->totals.bytes;
+	}
+	pthread_mutex_unlock(&stats_lock);
+
+	fprintf(out, "\nEstadisticas por fase:\n");
+	fprintf(out, "------------------------------------------------------------------------\n");
+	fprintf(out, "| Fase       |   Cantidad |   Total (ms) |     p50 (us) |     p99 (us) |\n");
+	fprintf(out, "------------------------------------------------------------------------\n");
+	for (int p = 0; p < STATS_PHASES; p++) {
+		const unsigned long long *h = hist + (size_t)p * STATS_BUCKETS;
+		fprintf(out, "| %-10s | %10llu | %12.3f | %12.3f | %12.3f |\n", stats_labels[p], totals.count[p],
+				(double)totals.total_ns[p] / 1e6,
+				(double)stats_percentile(h, totals.count[p], 50) / 1e3,
+				(double)stats_percentile(h, totals.count[p], 99) / 1e3);
+	}
+	fprintf(out, "------------------------------------------------------------------------\n");
+	fprintf(out, "Bytes leidos: %llu\n", totals.bytes);
+	free(hist);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file stats.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Medición de latencias por fase del análisis (opción --stats).
+ *
+ * Cada fase (apertura, lecturas del dispositivo, validación de cabeceras,
+ * búsqueda de tipos de partición e impresión) se mide con el reloj
+ * monótono. Los contadores son propios de cada hilo, de modo que medir no
+ * agrega sincronización al camino crítico: cada hilo acumula la cantidad,
+ * el tiempo total y un histograma logarítmico de las duraciones, del que se
+ * obtienen la mediana y el percentil 99 al final. Mientras la medición no se
+ * active, cada punto de medición cuesta una comparación.
+ * @copyright MIT License
+ */
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+/**
+ * @enum stats_phase
+ * @brief Fases que se miden.
+ */
+typedef enum {
+	STATS_OPEN = 0,     ///< Apertura del dispositivo (disk_open_flags()).
+	STATS_READ = 1,     ///< Cada lectura que llega al dispositivo o a la imagen.
+	STATS_VALIDATE = 2, ///< Validación de cabeceras y arreglos GPT (firma y CRC32).
+	STATS_LOOKUP = 3,   ///< Búsqueda del tipo de partición (MBR y GPT).
+	STATS_PRINT = 4,    ///< Impresión de las tablas y de los registros JSON.
+	STATS_PHASES = 5    ///< Cantidad de fases.
+} stats_phase;
+
+/**
+ * @struct stats_totals
+ * @brief Cantidad y tiempo total de cada fase, y bytes leídos.
+ *
+ * @var stats_totals::count
+ * Mediciones de cada fase.
+ * @var stats_totals::total_ns
+ * Tiempo acumulado de cada fase en nanosegundos.
+ * @var stats_totals::bytes
+ * Bytes leídos del dispositivo (fase STATS_READ).
+ */
+typedef struct {
+	unsigned long long count[STATS_PHASES];
+	unsigned long long total_ns[STATS_PHASES];
+	unsigned long long bytes;
+} stats_totals;
+
+/**
+ * @brief Activa la medición. Debe llamarse antes de crear los hilos de análisis.
+ */
+void stats_enable(void);
+
+/**
+ * @brief Indica si la medición está activa.
+ *
+ * @return int 1 si se llamó a stats_enable(), 0 en caso contrario.
+ */
+int stats_enabled(void);
+
+/**
+ * @brief Marca el comienzo de una medición.
+ *
+ * @return unsigned long long Instante actual del reloj monótono en
+ *         nanosegundos, o 0 si la medición no está activa.
+ */
+unsigned long long stats_begin(void);
+
+/**
+ * @brief Registra una medición en los contadores del hilo.
+ *
+ * @param phase Fase medida.
+ * @param start Valor que retornó stats_begin() (0 descarta la medición).
+ * @param bytes Bytes leídos (solo STATS_READ; 0 en las demás fases).
+ */
+void stats_end(stats_phase phase, unsigned long long start, unsigned long long bytes);
+
+/**
+ * @brief Copia los contadores del hilo que llama.
+ *
+ * Junto con stats_since() permite atribuir a un dispositivo lo medido
+ * mientras un hilo lo analizaba.
+ *
+ * @param out Contadores del hilo (en cero si todavía no midió nada).
+ */
+void stats_snapshot(stats_totals *out);
+
+/**
+ * @brief Reemplaza una copia de stats_snapshot() por lo medido desde entonces.
+ *
+ * @param snap Copia tomada por el mismo hilo.
+ */
+void stats_since(stats_totals *snap);
+
+/**
+ * @brief Nombre de una fase, usado como clave en JSON.
+ *
+ * @param phase Fase.
+ * @return "open", "read", "validate", "lookup" o "print".
+ */
+const char *stats_phase_name(stats_phase phase);
+
+/**
+ * @brief Imprime el resumen de todos los hilos: por fase la cantidad, el
+ *        tiempo total, la mediana y el percentil 99, y los bytes leídos.
+ *
+ * Debe llamarse cuando los hilos de análisis ya terminaron.
+ *
+ * @param out Flujo donde se imprime el resumen.
+ */
+void stats_report(FILE *out);
+
+#endif
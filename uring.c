@@ -0,0 +1,289 @@
+/**
+ * @file uring.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <string.h>
+#include "uring.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * @struct uring_ring
+ * @brief Anillos de envío y terminación mapeados desde el kernel.
+ */
+typedef struct {
+	int fd;
+	struct io_uring_params params;
+	void *sq_ptr;                 ///< Mapeo del anillo de envío.
+	void *cq_ptr;                 ///< Mapeo del anillo de terminación.
+	size_t sq_size;
+	size_t cq_size;
+	struct io_uring_sqe *sqes;    ///< Arreglo de entradas de envío.
+	size_t sqes_size;
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_cqe *cqes;
+} uring_ring;
+
+static void uring_teardown(uring_ring *ring) {
+	if (ring->sqes != NULL && ring->sqes != MAP_FAILED) {
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if (ring->cq_ptr != NULL && ring->cq_ptr != MAP_FAILED && ring->cq_ptr != ring->sq_ptr) {
+		munmap(ring->cq_ptr, ring->cq_size);
+	}
+	if (ring->sq_ptr != NULL && ring->sq_ptr != MAP_FAILED) {
+		munmap(ring->sq_ptr, ring->sq_size);
+	}
+	if (ring->fd >= 0) {
+		close(ring->fd);
+	}
+}
+
+static int uring_setup(uring_ring *ring, unsigned entries) {
+	memset(ring, 0, sizeof(uring_ring));
+	ring->fd = (int)syscall(__NR_io_uring_setup, entries, &ring->params);
+	if (ring->fd < 0) {
+		return 0;
+	}
+
+	struct io_uring_params *p = &ring->params;
+	ring->sq_size = p->sq_off.array + p->sq_entries * sizeof(unsigned);
+	ring->cq_size = p->cq_off.cqes + p->cq_entries * sizeof(struct io_uring_cqe);
+	if (p->features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_size > ring->sq_size) {
+			ring->sq_size = ring->cq_size;
+		}
+		ring->cq_size = ring->sq_size;
+	}
+
+	ring->sq_ptr = mmap(NULL, ring->sq_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	if (ring->sq_ptr == MAP_FAILED) {
+		uring_teardown(ring);
+		return 0;
+	}
+	if (p->features & IORING_FEAT_SINGLE_MMAP) {
+		ring->cq_ptr = ring->sq_ptr;
+	} else {
+		ring->cq_ptr = mmap(NULL, ring->cq_size, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+		if (ring->cq_ptr == MAP_FAILED) {
+			uring_teardown(ring);
+			return 0;
+		}
+	}
+	ring->sqes_size = p->sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ring->sqes == MAP_FAILED) {
+		uring_teardown(ring);
+		return 0;
+	}
+
+	char *sq = (char *)ring->sq_ptr;
+	char *cq = (char *)ring->cq_ptr;
+	ring->sq_head = (unsigned *)(sq + p->sq_off.head);
+	ring->sq_tail = (unsigned *)(sq + p->sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + p->sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + p->sq_off.array);
+	ring->cq_head = (unsigned *)(cq + p->cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + p->cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + p->cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + p->cq_off.cqes);
+	return 1;
+}
+
+/** @brief Clave cuyo destructor cierra el anillo de cada hilo al terminar. */
+static pthread_key_t uring_key;
+static pthread_once_t uring_key_once = PTHREAD_ONCE_INIT;
+static int uring_key_ok;
+
+/** @brief Anillo del hilo, creado en su primer lote y reutilizado en los siguientes. */
+static __thread uring_ring *uring_local;
+/** @brief 1 si el kernel no permitió crear el anillo en este hilo. */
+static __thread int uring_unavailable;
+
+static void uring_destroy(void *ptr) {
+	uring_ring *ring = (uring_ring *)ptr;
+	uring_teardown(ring);
+	free(ring);
+}
+
+static void uring_key_init(void) {
+	uring_key_ok = pthread_key_create(&uring_key, uring_destroy) == 0;
+}
+
+/**
+ * @brief Anillo del hilo que llama.
+ *
+ * Crear un anillo cuesta varias llamadas al sistema y tres proyecciones,
+ * por lo que cada hilo crea uno solo de URING_QUEUE_DEPTH entradas y lo
+ * conserva hasta terminar.
+ *
+ * @return Anillo, o NULL si io_uring no está disponible.
+ */
+static uring_ring *uring_thread_ring(void) {
+	if (uring_local != NULL || uring_unavailable) {
+		return uring_local;
+	}
+	pthread_once(&uring_key_once, uring_key_init);
+	uring_ring *ring = (uring_ring *)malloc(sizeof(uring_ring));
+	if (ring == NULL || !uring_key_ok || !uring_setup(ring, URING_QUEUE_DEPTH)) {
+		free(ring);
+		uring_unavailable = 1;
+		return NULL;
+	}
+	pthread_setspecific(uring_key, ring);
+	uring_local = ring;
+	return ring;
+}
+
+/**
+ * @brief Descarta el anillo del hilo después de un error; el siguiente lote crea otro.
+ */
+static void uring_thread_drop(void) {
+	if (uring_local != NULL) {
+		pthread_setspecific(uring_key, NULL);
+		uring_destroy(uring_local);
+		uring_local = NULL;
+	}
+}
+
+/**
+ * @brief Recoge las terminaciones disponibles y marca sus lecturas.
+ *
+ * @return Cantidad de terminaciones recogidas.
+ */
+static unsigned uring_reap(uring_ring *ring, uring_read *reqs) {
+	unsigned head = *ring->cq_head;
+	unsigned reaped = 0;
+
+	while (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+		struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+		uring_read *req = &reqs[cqe->user_data];
+		req->done = cqe->res >= 0 && (size_t)cqe->res == req->len;
+		head++;
+		reaped++;
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	return reaped;
+}
+
+/**
+ * @brief Espera las lecturas que el kernel ya aceptó.
+ *
+ * Cerrar el anillo no espera a las lecturas en curso, que seguirían
+ * escribiendo en los buffers del llamador después de liberarlos. Si la
+ * espera con io_uring_enter() también falla, se consulta el anillo de
+ * terminación cediendo el procesador hasta que lleguen todas.
+ */
+static void uring_drain(uring_ring *ring, uring_read *reqs, unsigned in_flight) {
+	int wait = 1;
+
+	while (in_flight > 0) {
+		if (wait && syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0
+				&& errno != EINTR) {
+			wait = 0;
+		}
+		if (!wait) {
+			sched_yield();
+		}
+		unsigned reaped = uring_reap(ring, reqs);
+		in_flight -= reaped < in_flight ? reaped : in_flight;
+	}
+}
+
+int uring_read_batch(uring_read *reqs, int count) {
+	uring_ring *ring;
+
+	for (int i = 0; i < count; i++) {
+		reqs[i].done = 0;
+	}
+	if (count <= 0) {
+		return 1;
+	}
+	if ((ring = uring_thread_ring()) == NULL) {
+		return 0;
+	}
+
+	int next = 0;
+	while (next < count) {
+		// Llenar el anillo de envío con la siguiente tanda de lecturas
+		unsigned tail = *ring->sq_tail;
+		unsigned queued = 0;
+		while (next < count && queued < ring->params.sq_entries) {
+			unsigned index = tail & *ring->sq_mask;
+			struct io_uring_sqe *sqe = &ring->sqes[index];
+			memset(sqe, 0, sizeof(struct io_uring_sqe));
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = reqs[next].fd;
+			sqe->off = reqs[next].offset;
+			sqe->addr = (unsigned long long)(unsigned long)reqs[next].buf;
+			sqe->len = (unsigned)reqs[next].len;
+			sqe->user_data = (unsigned long long)next;
+			ring->sq_array[index] = index;
+			tail++;
+			queued++;
+			next++;
+		}
+		__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+		// Enviar la tanda y recoger las terminaciones en el orden en que llegan
+		unsigned pending = queued;
+		unsigned to_submit = queued;
+		while (pending > 0) {
+			int ret = (int)syscall(__NR_io_uring_enter, ring->fd, to_submit, 1,
+					IORING_ENTER_GETEVENTS, NULL, 0);
+			if (ret < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				// Retirar las entradas que el kernel no tomó y esperar las que sí;
+				// las lecturas no enviadas quedan con done == 0
+				unsigned unsent = tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+				__atomic_store_n(ring->sq_tail, tail - unsent, __ATOMIC_RELEASE);
+				pending -= uring_reap(ring, reqs);
+				uring_drain(ring, reqs, pending - (unsent < pending ? unsent : pending));
+				uring_thread_drop();
+				return 1;
+			}
+			to_submit -= (unsigned)ret < to_submit ? (unsigned)ret : to_submit;
+			pending -= uring_reap(ring, reqs);
+		}
+	}
+	return 1;
+}
+
+#else
+
+int uring_read_batch(uring_read *reqs, int count) {
+	for (int i = 0; i < count; i++) {
+		reqs[i].done = 0;
+	}
+	return 0;
+}
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * @file uring.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Motor de lecturas asíncronas basado en io_uring.
+ *
+ * Permite enviar en un solo lote las lecturas de muchos dispositivos y
+ * recogerlas a medida que terminan. Se usa directamente la interfaz de
+ * llamadas al sistema del kernel, por lo que no depende de liburing. En
+ * sistemas sin io_uring las funciones informan que el motor no está
+ * disponible y el llamador usa las lecturas síncronas.
+ * @copyright MIT License
+ */
+#ifndef URING_H
+#define URING_H
+
+#include <stddef.h>
+
+/**
+ * @def URING_QUEUE_DEPTH
+ * @brief Cantidad máxima de lecturas en vuelo por anillo.
+ */
+#define URING_QUEUE_DEPTH 256
+
+/**
+ * @struct uring_read
+ * @brief Lectura posicionada que forma parte de un lote.
+ *
+ * @var uring_read::fd
+ * Descriptor de archivo desde el que se lee.
+ * @var uring_read::offset
+ * Desplazamiento en bytes dentro del archivo.
+ * @var uring_read::len
+ * Cantidad de bytes a leer.
+ * @var uring_read::buf
+ * Buffer destino.
+ * @var uring_read::done
+ * 1 si la lectura se completó por entero, 0 si debe repetirse por otra vía.
+ */
+typedef struct {
+	int fd;
+	unsigned long long offset;
+	size_t len;
+	void *buf;
+	int done;
+} uring_read;
+
+/**
+ * @brief Ejecuta un lote de lecturas con io_uring.
+ *
+ * Todas las lecturas se envían juntas (en tandas de URING_QUEUE_DEPTH) y se
+ * marcan como completas a medida que llegan sus terminaciones. Las lecturas
+ * que fallan o quedan incompletas conservan `done == 0`. Cada hilo usa un
+ * solo anillo, que crea en su primer lote y cierra al terminar. Al retornar
+ * no queda ninguna lectura en curso, aun si io_uring_enter() falla, de modo
+ * que el llamador puede liberar los buffers.
+ *
+ * @param reqs Lecturas a realizar.
+ * @param count Cantidad de lecturas.
+ * @return int 1 si se usó io_uring, 0 si no está disponible en este sistema.
+ */
+int uring_read_batch(uring_read *reqs, int count);
+
+#endif
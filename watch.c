@@ -0,0 +1,508 @@
+/**
+ * @file watch.c
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @copyright MIT License
+ */
+#include <dirent.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include "watch.h"
+#include "listpart.h"
+#include "print.h"
+#include "json.h"
+
+/**
+ * @brief Eventos de inotify que pueden indicar un cambio en la tabla de particiones.
+ *
+ * IN_Q_OVERFLOW (con `wd` igual a -1) se recibe siempre, aunque no figure en la máscara.
+ */
+#define WATCH_INOTIFY_MASK (IN_CREATE | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)
+
+/**
+ * @struct watch_device
+ * @brief Dispositivo o imagen vigilado y su último resultado.
+ */
+typedef struct {
+	char *path;     ///< Ruta del dispositivo.
+	char *record;   ///< Último registro JSON (sin `event`), o NULL si el dispositivo no existe.
+	int pending;    ///< 1 si hay que volver a analizarlo.
+} watch_device;
+
+/**
+ * @struct watch_dir
+ * @brief Directorio vigilado con inotify.
+ */
+typedef struct {
+	char *path;     ///< Ruta del directorio.
+	int wd;         ///< Descriptor de vigilancia de inotify.
+	int all;        ///< 1 si cualquier entrada nueva es un dispositivo a vigilar.
+} watch_dir;
+
+/**
+ * @struct watch_state
+ * @brief Estado de la vigilancia.
+ */
+typedef struct {
+	watch_device *devices;
+	int device_count;
+	int device_capacity;
+	watch_dir *dirs;
+	int dir_count;
+	int dir_capacity;
+	int inotify_fd;
+	int uevent_fd;                     ///< Socket de uevents, o -1 si no está disponible.
+	int all_disks;                     ///< 1 si se vigilan todos los discos del sistema.
+	int flags;                         ///< Opciones del análisis.
+	FILE *out;
+	unsigned long long first_pending;  ///< Instante (ms) del primer evento sin procesar, o 0.
+	unsigned long long last_event;     ///< Instante (ms) del último evento.
+	listpart_partition *parts;         ///< Arreglo de particiones reutilizado entre análisis.
+	unsigned int parts_capacity;
+	json_writer writer;
+} watch_state;
+
+static unsigned long long now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000ULL + (unsigned long long)ts.tv_nsec / 1000000ULL;
+}
+
+static int find_device(const watch_state *state, const char *path) {
+	for (int i = 0; i < state->device_count; i++) {
+		if (strcmp(state->devices[i].path, path) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * @brief Agrega un dispositivo a la lista, si no estaba.
+ *
+ * @return Índice del dispositivo, o -1 si no hay memoria.
+ */
+static int add_device(watch_state *state, const char *path) {
+	int index = find_device(state, path);
+	if (index >= 0) {
+		return index;
+	}
+	if (state->device_count == state->device_capacity) {
+		int capacity = state->device_capacity > 0 ? 2 * state->device_capacity : 16;
+		watch_device *devices = (watch_device *)realloc(state->devices, (size_t)capacity * sizeof(watch_device));
+		if (devices == NULL) {
+			return -1;
+		}
+		state->devices = devices;
+		state->device_capacity = capacity;
+	}
+	watch_device *device = &state->devices[state->device_count];
+	if ((device->path = strdup(path)) == NULL) {
+		return -1;
+	}
+	device->record = NULL;
+	device->pending = 0;
+	return state->device_count++;
+}
+
+/**
+ * @brief Vigila un directorio con inotify, si no se vigilaba ya.
+ *
+ * @param all 1 si las entradas nuevas del directorio deben agregarse como dispositivos.
+ * @return int 1 si el directorio quedó vigilado, 0 en caso contrario.
+ */
+static int add_dir(watch_state *state, const char *path, int all) {
+	for (int i = 0; i < state->dir_count; i++) {
+		if (strcmp(state->dirs[i].path, path) == 0) {
+			state->dirs[i].all |= all;
+			return 1;
+		}
+	}
+	if (state->dir_count == state->dir_capacity) {
+		int capacity = state->dir_capacity > 0 ? 2 * state->dir_capacity : 8;
+		watch_dir *dirs = (watch_dir *)realloc(state->dirs, (size_t)capacity * sizeof(watch_dir));
+		if (dirs == NULL) {
+			return 0;
+		}
+		state->dirs = dirs;
+		state->dir_capacity = capacity;
+	}
+	int wd = inotify_add_watch(state->inotify_fd, path, WATCH_INOTIFY_MASK);
+	if (wd < 0) {
+		fprintf(stderr, "Advertencia: No se puede vigilar el directorio %s: %s\n", path, strerror(errno));
+		return 0;
+	}
+	watch_dir *dir = &state->dirs[state->dir_count];
+	if ((dir->path = strdup(path)) == NULL) {
+		inotify_rm_watch(state->inotify_fd, wd);
+		return 0;
+	}
+	dir->wd = wd;
+	dir->all = all;
+	state->dir_count++;
+	return 1;
+}
+
+static void mark_pending(watch_state *state, int index) {
+	unsigned long long now = now_ms();
+	if (index < 0) {
+		return;
+	}
+	state->devices[index].pending = 1;
+	if (state->first_pending == 0) {
+		state->first_pending = now;
+	}
+	state->last_event = now;
+}
+
+/**
+ * @brief Indica si una ruta es una imagen (archivo regular) o un dispositivo de bloque.
+ */
+static int is_disk_path(const char *path) {
+	struct stat st;
+	return stat(path, &st) == 0 && (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode));
+}
+
+/**
+ * @brief Analiza un dispositivo y construye su registro JSON.
+ *
+ * @return Registro terminado en '\n' (liberar con `free`), o NULL si el
+ *         dispositivo no existe.
+ */
+static char *render_record(watch_state *state, const char *path) {
+	listpart_result result;
+	disk_handle disk;
+	char *record = NULL;
+	size_t len = 0;
+	FILE *mem;
+
+	if (!is_disk_path(path) || (mem = open_memstream(&record, &len)) == NULL) {
+		return NULL;
+	}
+	json_init(&state->writer, mem);
+	json_begin_object(&state->writer, NULL);
+	json_string(&state->writer, "device", path);
+	if (!disk_open_flags(&disk, path, (state->flags & LISTPART_DIRECT) ? DISK_OPEN_DIRECT : 0)) {
+		json_string(&state->writer, "status", "error");
+		json_string(&state->writer, "error", "No se pudo abrir el dispositivo");
+	} else {
+		listpart_result_init(&result, state->parts, state->parts_capacity);
+		listpart_parse_disk(&disk, state->flags, &result);
+		if (result.total > result.count) {
+			listpart_partition *parts =
+				(listpart_partition *)realloc(state->parts, result.total * sizeof(listpart_partition));
+			if (parts != NULL) {
+				state->parts = parts;
+				state->parts_capacity = result.total;
+				listpart_result_init(&result, parts, result.total);
+				listpart_parse_disk(&disk, state->flags, &result);
+			}
+		}
+		disk_close(&disk);
+		json_listpart_result(&state->writer, &result);
+	}
+	json_end_object(&state->writer);
+	json_end_record(&state->writer);
+	fclose(mem);
+	return record;
+}
+
+/**
+ * @brief Escribe un registro con el miembro `event` delante de los demás.
+ */
+static void emit(watch_state *state, const char *event, const watch_device *device, const char *record) {
+	if (record != NULL) {
+		// El registro empieza con '{': se inserta el evento como primer miembro
+		fprintf(state->out, "{\"event\":\"%s\",%s", event, record + 1);
+		return;
+	}
+	fflush(state->out);
+	json_init(&state->writer, state->out);
+	json_begin_object(&state->writer, NULL);
+	json_string(&state->writer, "event", event);
+	json_string(&state->writer, "device", device->path);
+	json_end_object(&state->writer);
+	json_end_record(&state->writer);
+}
+
+/**
+ * @brief Vuelve a analizar los dispositivos pendientes y escribe los que cambiaron.
+ */
+static void process_pending(watch_state *state) {
+	for (int i = 0; i < state->device_count; i++) {
+		watch_device *device = &state->devices[i];
+		if (!device->pending) {
+			continue;
+		}
+		device->pending = 0;
+		char *record = render_record(state, device->path);
+		if (device->record == NULL && record != NULL) {
+			emit(state, "added", device, record);
+		} else if (device->record != NULL && record == NULL) {
+			emit(state, "removed", device, NULL);
+		} else if (device->record != NULL && strcmp(device->record, record) != 0) {
+			emit(state, "changed", device, record);
+		}
+		free(device->record);
+		device->record = record;
+	}
+	fflush(state->out);
+	state->first_pending = 0;
+}
+
+static void add_dir_entries(watch_state *state, const char *dir_path);
+
+/**
+ * @brief Recupera los eventos perdidos al desbordarse la cola de inotify.
+ *
+ * Se vuelven a analizar todos los dispositivos y se relee cada directorio
+ * vigilado entero para detectar las entradas nuevas.
+ */
+static void handle_overflow(watch_state *state) {
+	for (int i = 0; i < state->device_count; i++) {
+		mark_pending(state, i);
+	}
+	for (int d = 0; d < state->dir_count; d++) {
+		if (state->dirs[d].all) {
+			add_dir_entries(state, state->dirs[d].path);
+		}
+	}
+}
+
+static void handle_inotify(watch_state *state) {
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	char path[PATH_MAX];
+	ssize_t len;
+
+	while ((len = read(state->inotify_fd, buf, sizeof(buf))) > 0) {
+		for (char *p = buf; p < buf + len; ) {
+			const struct inotify_event *event = (const struct inotify_event *)p;
+			p += sizeof(struct inotify_event) + event->len;
+			if (event->mask & IN_Q_OVERFLOW) {
+				handle_overflow(state);
+				continue;
+			}
+			if (event->len == 0) {
+				continue;
+			}
+			for (int d = 0; d < state->dir_count; d++) {
+				const watch_dir *dir = &state->dirs[d];
+				if (dir->wd != event->wd) {
+					continue;
+				}
+				snprintf(path, sizeof(path), "%s/%s", dir->path, event->name);
+				int index = find_device(state, path);
+				if (index < 0 && dir->all && is_disk_path(path)) {
+					index = add_device(state, path);
+				}
+				mark_pending(state, index);
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Procesa los uevents del kernel de los discos (no de sus particiones).
+ */
+static void handle_uevent(watch_state *state) {
+	char buf[8192];
+	char path[PATH_MAX];
+	ssize_t len;
+
+	while ((len = recv(state->uevent_fd, buf, sizeof(buf) - 1, MSG_DONTWAIT)) > 0) {
+		const char *action = NULL, *subsystem = NULL, *devtype = NULL, *devname = NULL;
+		buf[len] = '\0';
+		// Mensaje: "accion@ruta" seguido de pares CLAVE=VALOR separados por '\0'
+		for (char *p = buf; p < buf + len; p += strlen(p) + 1) {
+			if (strncmp(p, "ACTION=", 7) == 0) {
+				action = p + 7;
+			} else if (strncmp(p, "SUBSYSTEM=", 10) == 0) {
+				subsystem = p + 10;
+			} else if (strncmp(p, "DEVTYPE=", 8) == 0) {
+				devtype = p + 8;
+			} else if (strncmp(p, "DEVNAME=", 8) == 0) {
+				devname = p + 8;
+			}
+		}
+		if (action == NULL || subsystem == NULL || devtype == NULL || devname == NULL
+				|| strcmp(subsystem, "block") != 0 || strcmp(devtype, "disk") != 0) {
+			continue;
+		}
+		snprintf(path, sizeof(path), "%s%s", devname[0] == '/' ? "" : "/dev/", devname);
+		int index = find_device(state, path);
+		if (index < 0 && state->all_disks && strcmp(action, "remove") != 0) {
+			index = add_device(state, path);
+		}
+		mark_pending(state, index);
+	}
+}
+
+static int open_uevent_socket(void) {
+	struct sockaddr_nl addr;
+	int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+
+	if (fd < 0) {
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_pid = 0;
+	addr.nl_groups = 1; // Eventos emitidos por el kernel
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+ * @brief Agrega las entradas de un directorio que son imágenes o dispositivos.
+ */
+static void add_dir_entries(watch_state *state, const char *dir_path) {
+	struct dirent **names;
+	char path[PATH_MAX];
+	int n = scandir(dir_path, &names, NULL, alphasort);
+
+	for (int i = 0; i < n; i++) {
+		if (names[i]->d_name[0] != '.') {
+			snprintf(path, sizeof(path), "%s/%s", dir_path, names[i]->d_name);
+			if (is_disk_path(path)) {
+				mark_pending(state, add_device(state, path));
+			}
+		}
+		free(names[i]);
+	}
+	if (n >= 0) {
+		free(names);
+	}
+}
+
+/**
+ * @brief Agrega todos los discos de /sys/block con tamaño distinto de cero.
+ */
+static void add_system_disks(watch_state *state) {
+	struct dirent **names;
+	char path[PATH_MAX];
+	int n = scandir("/sys/block", &names, NULL, alphasort);
+
+	for (int i = 0; i < n; i++) {
+		unsigned long long size = 0;
+		FILE *f;
+		snprintf(path, sizeof(path), "/sys/block/%s/size", names[i]->d_name);
+		if (names[i]->d_name[0] != '.' && (f = fopen(path, "r")) != NULL) {
+			if (fscanf(f, "%llu", &size) != 1) {
+				size = 0;
+			}
+			fclose(f);
+		}
+		if (size > 0) {
+			snprintf(path, sizeof(path), "/dev/%s", names[i]->d_name);
+			mark_pending(state, add_device(state, path));
+		}
+		free(names[i]);
+	}
+	if (n >= 0) {
+		free(names);
+	}
+}
+
+/**
+ * @brief Registra un dispositivo, imagen o directorio indicado por el usuario.
+ */
+static void add_target(watch_state *state, const char *target) {
+	char dir[PATH_MAX];
+	struct stat st;
+
+	if (stat(target, &st) == 0 && S_ISDIR(st.st_mode)) {
+		add_dir(state, target, 1);
+		add_dir_entries(state, target);
+		return;
+	}
+	// Vigilar el directorio que lo contiene detecta también el reemplazo por renombre
+	const char *slash = strrchr(target, '/');
+	if (slash == NULL) {
+		snprintf(dir, sizeof(dir), ".");
+	} else if (slash == target) {
+		snprintf(dir, sizeof(dir), "/");
+	} else {
+		snprintf(dir, sizeof(dir), "%.*s", (int)(slash - target), target);
+	}
+	add_dir(state, dir, 0);
+	mark_pending(state, add_device(state, target));
+}
+
+int watch_run(char **targets, int count, int flags, FILE *out) {
+	static watch_state state;
+
+	memset(&state, 0, sizeof(state));
+	state.flags = flags;
+	state.out = out;
+	state.inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (state.inotify_fd < 0) {
+		fprintf(stderr, "Error: No se pudo iniciar inotify: %s\n", strerror(errno));
+		return 0;
+	}
+	state.uevent_fd = open_uevent_socket();
+	state.all_disks = count == 0;
+	if (state.all_disks) {
+		if (state.uevent_fd < 0) {
+			fprintf(stderr, "Advertencia: No se pueden recibir los eventos de discos del kernel\n");
+		}
+		add_dir(&state, "/dev", 0);
+		add_system_disks(&state);
+	}
+	for (int i = 0; i < count; i++) {
+		add_target(&state, targets[i]);
+	}
+	process_pending(&state);
+
+	for (;;) {
+		struct pollfd fds[2];
+		int nfds = 0;
+		int timeout = -1;
+
+		fds[nfds].fd = state.inotify_fd;
+		fds[nfds++].events = POLLIN;
+		if (state.uevent_fd >= 0) {
+			fds[nfds].fd = state.uevent_fd;
+			fds[nfds++].events = POLLIN;
+		}
+		if (state.first_pending != 0) {
+			// Esperar a que los eventos se calmen, sin demorar más de WATCH_MAX_DELAY_MS
+			unsigned long long due = state.last_event + WATCH_SETTLE_MS;
+			unsigned long long limit = state.first_pending + WATCH_MAX_DELAY_MS;
+			unsigned long long now = now_ms();
+			if (limit < due) {
+				due = limit;
+			}
+			timeout = due > now ? (int)(due - now) : 0;
+		}
+		if (poll(fds, (nfds_t)nfds, timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			fprintf(stderr, "Error: Fallo la espera de eventos: %s\n", strerror(errno));
+			return 0;
+		}
+		handle_inotify(&state);
+		if (state.uevent_fd >= 0) {
+			handle_uevent(&state);
+		}
+		if (state.first_pending != 0) {
+			unsigned long long now = now_ms();
+			if (now >= state.last_event + WATCH_SETTLE_MS || now >= state.first_pending + WATCH_MAX_DELAY_MS) {
+				process_pending(&state);
+			}
+		}
+	}
+}
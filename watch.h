@@ -0,0 +1,54 @@
+/**
+ * @file watch.h
+ * @author Julian Alejandro Munoz Perez<julianalejom@unicauca.edu.co>
+ * @author Monica Alejandra Castellanos Mendez<monicacastellanos@unicauca.edu.co>
+ * @brief Modo de vigilancia: vuelve a analizar solo los dispositivos que cambian.
+ *
+ * Mantiene en memoria el último resultado de cada dispositivo vigilado y
+ * espera eventos en lugar de leer los discos periódicamente:
+ *
+ * - inotify sobre los directorios vigilados (o el directorio de cada
+ *   dispositivo o imagen indicado), para altas, bajas, renombres y
+ *   escrituras cerradas.
+ * - uevents del kernel por netlink (subsistema `block`), que informan la
+ *   aparición y desaparición de discos y la relectura de su tabla de
+ *   particiones.
+ *
+ * Los eventos se agrupan durante WATCH_SETTLE_MS; luego se analizan los
+ * dispositivos afectados y solo se escriben los que cambiaron, un registro
+ * NDJSON por dispositivo con el miembro `event` ("added", "changed" o
+ * "removed") y los mismos campos que el modo -J.
+ * @copyright MIT License
+ */
+#ifndef WATCH_H
+#define WATCH_H
+
+#include <stdio.h>
+
+/**
+ * @def WATCH_SETTLE_MS
+ * @brief Milisegundos sin eventos que se esperan antes de analizar los dispositivos afectados.
+ */
+#define WATCH_SETTLE_MS 200
+
+/**
+ * @def WATCH_MAX_DELAY_MS
+ * @brief Demora máxima de un análisis pendiente aunque sigan llegando eventos.
+ */
+#define WATCH_MAX_DELAY_MS 2000
+
+/**
+ * @brief Vigila dispositivos e imágenes hasta que ocurra un error.
+ *
+ * Al comenzar escribe un registro "added" por cada dispositivo existente.
+ *
+ * @param targets Dispositivos, imágenes o directorios de imágenes. Sin
+ *                ninguno, se vigilan todos los discos de /sys/block.
+ * @param count Cantidad de elementos de `targets`.
+ * @param flags Opciones del análisis (LISTPART_CHECK_BACKUP, LISTPART_PROBE_FS).
+ * @param out Flujo donde se escriben los registros.
+ * @return int 0 si no se pudo iniciar la vigilancia; no retorna mientras funcione.
+ */
+int watch_run(char **targets, int count, int flags, FILE *out);
+
+#endif